@@ -16,6 +16,7 @@
 **         SI_Timer_OnInterrupt - void SI_Timer_OnInterrupt(void);
 **         AO_OnEnd             - void AO_OnEnd(void);
 **         AO_OnCalibrationEnd  - void AO_OnCalibrationEnd(void);
+**         LineCam_OnFrame      - void LineCam_OnFrame(const uint16_t *frame);
 **         Cpu_OnNMIINT         - void Cpu_OnNMIINT(void);
 **
 ** ###################################################################*/
@@ -42,41 +43,64 @@ extern "C" {
 
 /* User includes (#include below this line is not maintained by Processor Expert) */
 #include "Motors.h"
+#include "LineCamera.h"
+#include "LineFinder.h"
+#include "Telemetry.h"
+#include "Timebase.h"
+#include "Params.h"
+#include "Trace.h"
+#include "Fixed.h"
+#include "Steering.h"
+#include "Speed.h"
+#include "Planner.h"
 
 /* ---------------------------------------- Global variables and constants ----------------------------------------- */
 // Configurable constants and coefficients
-const double Kps = 30;		// P constant for steering
-const double Kds = 2.5;		// D constant for steering
-const double Kpv = 1;		// P constant for velocity
-const double Ka = 1;		// Attenuation constant for when we veer off path
-const double Bv = 0.1;		// Infinite impulse response ratio for velocity smoothing
-const double Bs = 0.1;		// IIR ratio for steering smoothing
-double velocity_max = 36.0; // inches per second, max speed for straight paths
-const uint8_t num_magnets = 4; // Number of magnets
+// Kps, Kds, Kis, Kpv, Kiv, Bv, Bs, velocity_max, the planner accelerations, the steering gain schedule, Diff_Gain and the Servo_*, Duty_Max, Brake_Max and Motor_* limits are tunable at runtime, see Params.c
+#define Num_Magnets 4 // Number of magnets
+#define Velocity_Clk_Hz 2621440 // Cap1 counter clock. TODO: Figure out where this clk_freq comes from???
+#define Wheel_Radius 1.25 // inches
+// Inches travelled between two magnets times the counter clock, velocity = this / ticks. Folds to a constant.
+#define Velocity_Tick_Inches ((int32_t)(Wheel_Radius * (6.28 / Num_Magnets) * Velocity_Clk_Hz + 0.5))
 
 // Line camera variables
 static volatile uint16_t count = 0;		//The index of the pixels from the line camera.
-volatile char pixel[150] = {0};			//The pixel values of the line camera.
+static uint32_t pixel_bits[LINECAM_WORDS] = {0};	//The thresholded line camera frame, 1 = white.
+LineFind_t line_position = {0};						//The line found in the last frame.
+LineTrack_t line_track = {0};						//Where to look for the line in the next frame.
+LineScene_t line_scene = {0};						//Every dark run in the last frame and what they mean.
+uint16_t lap_count = 0;								//Start/finish marks seen so far.
 #define Pixel_Count 130					//The number of pixels we are going to read before resetting the camera.
 const char desired_center = 64;			//The target center index of the black line is half of 128.
 
-const uint16_t Servo_Center = 20000 - 750;			//The servo center command in us.
-const uint16_t Servo_Left	= 20000 - 450;			//The servo max left command in us.
-const uint16_t Servo_Right  = 20000 - 1050;			//The servo max right command in us.
+
+// Steering stuff
+static int16_t error_q8_prev = 0;		//Steering error of the last frame with a line, for telemetry.
+static uint16_t servo_command = 20000 - 750;	//Last command sent to the servo, for telemetry.
+static Steering_t steering;
 
 // Velocity sensing stuff
-double velocity = 0.0; // inches per second
-double velocity_desired = 0.0; // inches per second, just a starting val
+Q16_t velocity = 0; // inches per second
+Q16_t velocity_desired = 0; // inches per second, just a starting val
 int ovf = 0; // overflow control CNT
-static uint16_t interrupts_since_velocity_update = 0;
+static volatile uint32_t velocity_update_us = 0; // Last Cap1 capture, written by its ISR
+#define VELOCITY_TIMEOUT_US 500000 // No magnet for this long means stopped, about 4 in/s
 
 // Motor control stuff
+static Speed_t speed;
+static Planner_t planner;
+#define SPEED_BRAKE MotorDir_Brake // Brake direction when we are above the setpoint, the one that follows the duty
 
 // Config switches
-#define USE_LINE_WEIGHTED_CENTER false // TODO: actually setup config enable/disable
-#define USE_SERVO_PD false // TODO: actually setup config enable/disable
+#define USE_LINE_WEIGHTED_CENTER 1 // 1: sub-pixel centroid over the grayscale frame, 0: midpoint of the edges
+#define USE_SERVO_PD 1 // 1: PID steering with the gains in params, 0: proportional only (Kds and Kis ignored)
 #define USE_VELOCITY_IIR false // TODO: actually setup config enable/disable
 
+// Private function declarations
+static bool line_evaluate(const uint16_t *frame, uint16_t threshold, uint32_t timestamp_us);
+static void velocity_update_desired(uint32_t timestamp_us);
+static void motors_update(uint32_t timestamp_us);
+static void telemetry_update(uint32_t timestamp_us, const uint16_t *frame, uint16_t threshold);
 
 
 
@@ -97,39 +121,28 @@ static uint16_t interrupts_since_velocity_update = 0;
 
 void Cap1_OnCapture(void)
 {
-	interrupts_since_velocity_update = 0;
+	velocity_update_us = timebase_us();
 	// Constants and statics
 	static uint16_t old_time = 0;
-	// TODO: Figure out where this clk_freq comes from???
-	const double clk_freq = 2621440; // Hz
-	const double _radius = 1.25; // inches
-	const double _angle = 6.28 / num_magnets; // radians, tau / num = radial spacing
+	static Q16_t yn_prev = 0;
 
 	// Read in the newest time in clock cycles
 	uint16_t new_time = 0;
 	Cap1_GetCaptureValue(&new_time);
+	trace(Trace_Capture, 0, new_time);
 
-	// Calculate current speed
-	double time = new_time - old_time;	//Get the tick difference.
-	time = time / clk_freq;	//convert back to seconds.
-	// TODO: Figure out where 0.025 comes from???
-	time = time + (ovf * 0.025); // correction for overflow event CNT
+	// Calculate current speed, every overflow in between is one full 16 bit count (0.025s at Velocity_Clk_Hz)
+	int32_t time = (int32_t)new_time - old_time + ((int32_t)ovf << 16);	//Get the tick difference.
 	old_time = new_time; //Store the current time into the old time for next use.
-	velocity = _radius * _angle / time; //Calculate the velocity in inches / seconds.
 	ovf = 0;
+	if (time <= 0) {
+		return;
+	}
 
 	// Calculate velocity using new method
-	double yn = _radius * _angle / time;
-	static double yn_prev = 0;
-	velocity = (1-Bv) * yn + Bv * yn_prev;
+	Q16_t yn = q16_div(Velocity_Tick_Inches, time); //Calculate the velocity in inches / seconds.
+	velocity = q16_lerp(yn, yn_prev, params.Bv >> 1); // (1-Bv) * yn + Bv * yn_prev
 	yn_prev = yn;
-
-	// Update speed
-	static uint16_t PWM = 0; // Starting speed
-	uint16_t delta_PWM = Kpv * (velocity_desired - velocity);
-	PWM = PWM + delta_PWM;
-//	motors_set(MotorDir_Forward, PWM);
-//	motors_set(MotorDir_Forward, 0);
 }
 
 /*
@@ -170,108 +183,24 @@ void Cap1_OnOverflow(void)
 */
 void Clk_OnEnd(void)
 {
-	// Velocity variables
-	static uint16_t PWM = 20000 - 750; // Start going straight
-	static uint16_t delta_PWM = 0; // Assume no turn at the start
-	static char error_prev = 0;
-	static double un_prev = 0;
-	const char error_max = 64;
-
 	// Line camera stuff. I'm 95% confident that John wrote this??
 	if(count > Pixel_Count)	//Sets up the SI Pulse for a new measurement.
 	{
-		SI_Timer_Enable();
+		linecam_start_frame();
+		trace(Trace_FrameStart, 0, linecam_frame_count);
 		count = 0; //This is to do a minor offset to correct for the incrementation of count.
-		AS1_SendChar('*');
 		return;
 	}
-	else if (count == Pixel_Count) //All pixels have been read, now we can evaluate them.
+	else if (count == Pixel_Count) //All pixels have been read, hand them over to the main loop.
 	{
-		// Normal way to figure out the center
-		char start = -1;
-		char end   = -1;
-		// My way to figure out the center by averaging the indices of the black pixel
-		uint16_t center_indices_sum = 0;
-		uint16_t center_indices_count = 0;
-		for (int i = 0; i < 127; ++i) {
-			// My method
-			if (pixel[i] == '0') { // Black pixel
-				center_indices_sum += i + 1;
-				center_indices_count += 1;
-			}
-			// Normal method
-			if (pixel[i] == '1' && pixel[i+1] == '0' && end == -1) {
-				start = i + 1;
-				continue;
-			}
-			if (pixel[i] == '0' && pixel[i+1] == '1' && start != -1) {
-				end = i + 1;
-				break;
-			}
-		}
-
-		if (start == -1 || end == -1)	//If we failed to locate the line then just jump away.
-		{
-			count++;
-			return;
-		}
-		unsigned char actual_center = start + ((end - start) / 2);
-//		if (center_indices_count == 0) {
-//			count++;
-//			return;
-//		}
-//		 unsigned char actual_center = center_indices_sum / center_indices_count;
-
-
-		//Now we can calculate the error and do the PID control for the servo.
-		char error = desired_center - actual_center;
-
-		char dError = error - error_prev;		 //
-		const double dT = Pixel_Count * 0.001; //Seconds.
-		uint16_t Servo_Command = Servo_Center + (Kps * error) ;//+ (Kds * dError/dT);
-
-		//These may have to be flipped.
-		if (Servo_Command > Servo_Left) {
-			Servo_Command = Servo_Left;
-		}
-
-		else if (Servo_Command < Servo_Right) {
-			Servo_Command = Servo_Right;
-		}
-
-
-		Servo_SetDutyUS(Servo_Command);
-
-		// Use our method not John's
-
-//		const unsigned char delta_T = 20; // 20 ms???
-
-//		double un = Kps * error + Kds * (error - error_prev) / delta_T;
-//		delta_PWM = (1-Bs) * un + Bs * un_prev;
-//		PWM = Servo_Center + delta_PWM;
-////		Servo_SetDutyUS(PWM);
-
-		error_prev = error;
-//		un_prev = un;
-
+		trace(Trace_FrameDone, 0, linecam_frame_count);
+		linecam_frame_done();
 	}
 	else if (count < 129) //Read each pixel for count = 0 to 127.
 	{
 		AO_Measure(0);
 	}
 	count++;
-
-	// Velocity detecting stuff
-	if (interrupts_since_velocity_update > 50) { // 50 * 20ms = 1s
-		// If it has been too long since an update to velocity, it's stopped
-		velocity = 0;
-//		motors_set(MotorDir_Forward, 0xFFFF/8);
-	}
-	interrupts_since_velocity_update++;
-	// Update desired velocity
-	char error_prev_abs = error_prev < 0 ? -error_prev : error_prev;
-	velocity_desired = (1 - error_prev_abs / ((double) error_max)) * velocity_max;
-//	velocity_desired = velocity_max - Ka * delta_PWM;
 }
 
 /*
@@ -291,16 +220,7 @@ void Clk_OnEnd(void)
 
 void SI_Timer_OnInterrupt(void)
 {
-	static bool SI_Flag = 0;
-	if (SI_Flag) {
-		SI_ClrVal();
-		SI_Flag = 0;
-		SI_Timer_Disable();
-	}
-	else {
-		SI_SetVal();
-		SI_Flag = 1;
-	}
+	linecam_on_si_timer();
 }
 
 /*
@@ -320,19 +240,14 @@ void SI_Timer_OnInterrupt(void)
 void AO_OnEnd(void)
 {
 	count--;
-	const uint16_t Threshold = (2.5 / 3.3) * (65535);	//ADC Result equivalent.
 	uint16_t ADC_Value = 0;
 	AO_GetValue16(&ADC_Value);
-
-	if (ADC_Value >= Threshold) {
-		pixel[count] = '1';
-	}
-	else {
-		pixel[count] = '0';
-	}
+	linecam_store_pixel(count, ADC_Value);
+#if TRACE_PIXEL_EVENTS
+	trace(Trace_Pixel, count, ADC_Value);
+#endif
 
 	count++;
-	AS1_SendChar(pixel[count]);
 }
 
 
@@ -355,6 +270,51 @@ void AO_OnCalibrationEnd(void)
   /* Write your code here ... */
 }
 
+/*
+** ===================================================================
+**     Event       :  LineCam_OnFrame (module Events)
+**
+**     Component   :  LineCamera [DMA]
+**     Description :
+**         This event is called from linecam_poll in the main loop
+**         for every new frame. The frame stays untouched by
+**         acquisition until the event returns.
+**     Parameters  :
+**         NAME            - DESCRIPTION
+**       * frame           - Pointer to LINECAM_PIXELS raw ADC samples
+**     Returns     : Nothing
+** ===================================================================
+*/
+void LineCam_OnFrame(const uint16_t *frame)
+{
+	uint32_t timestamp_us = timebase_us();
+	params_apply(); // Parameters only change between frames
+	linecam_exposure_update(frame);
+	uint16_t threshold = linecam_threshold(frame);
+	linecam_binarize(frame, threshold, pixel_bits);
+
+	// Lost for too long means we left the track, keep what led up to it. Only armed once the
+	// line has been followed for a while, a car waiting off the track isn't a crash.
+	static bool tracking = FALSE;
+	static bool armed = FALSE;
+	static uint32_t since_us = 0;		// Start of the current tracking or lost stretch
+	bool found = line_evaluate(frame, threshold, timestamp_us);
+	if (found != tracking) {
+		tracking = found;
+		since_us = timestamp_us;
+	}
+	if (tracking && timestamp_us - since_us >= TRACE_ARM_US) {
+		armed = TRUE;
+	}
+	else if (!tracking && armed && timestamp_us - since_us >= TRACE_LOST_US) {
+		armed = FALSE;
+		trace_fault(TraceFault_LineLost, 0);
+	}
+	velocity_update_desired(timestamp_us);
+	motors_update(timestamp_us);
+	telemetry_update(timestamp_us, frame, threshold);
+}
+
 /*
 ** ===================================================================
 **     Event       :  Cpu_OnNMIINT (module Events)
@@ -373,6 +333,163 @@ void Cpu_OnNMIINT(void)
   /* Write your code here ... */
 }
 
+/* ---------------------------------------- Private function definitions ----------------------------------------- */
+// Finds the line in the frame and steers towards it. Returns false if there was no line.
+static bool line_evaluate(const uint16_t *frame, uint16_t threshold, uint32_t timestamp_us)
+{
+	static LineClass_t type_prev = LineClass_Lost;
+	LineClass_t type = lineclass_classify(pixel_bits, &line_scene);
+	if (type == LineClass_Finish && type_prev != LineClass_Finish) {
+		lap_count++;
+	}
+	type_prev = type;
+	trace(Trace_Line, type, line_scene.count);
+	if (type == LineClass_Crossing) {
+		return TRUE; // The line is under the other track, hold the last servo command
+	}
+
+	uint8_t start = 0;
+	uint8_t end = 0;
+	if (type == LineClass_Lost || !linetrack_find(&line_track, pixel_bits, &start, &end))	//If we failed to locate the line then just jump away.
+	{
+		linetrack_lost(&line_track);
+		steering_reset(&steering);
+		return FALSE;
+	}
+#if USE_LINE_WEIGHTED_CENTER
+	if (!linefind_centroid(frame, threshold, start, end, &line_position)) {
+		linetrack_lost(&line_track);
+		steering_reset(&steering);
+		return FALSE;
+	}
+#else
+	line_position.start = start;
+	line_position.width = end - start;
+	line_position.center_q8 = (LINEFIND_Q8(start) + LINEFIND_Q8(end)) / 2; // Middle of [start, end)
+	line_position.confidence = 255;
+#endif
+
+
+	linetrack_update(&line_track, line_position.center_q8);
+
+	//Now we can calculate the error and do the PID control for the servo.
+	int16_t error_q8 = LINEFIND_Q8(desired_center) - line_position.center_q8;
+
+	SteeringGains_t gains = {
+		.kp = params.Kps,
+#if USE_SERVO_PD
+		.ki = params.Kis,
+		.kd = params.Kds,
+#endif
+		.d_filter = params.Bs >> 1,
+		.slew = params.Servo_Slew,
+		.center = params.Servo_Center,
+		.left = params.Servo_Left,
+		.right = params.Servo_Right,
+	};
+	steering_schedule(&params.steer_schedule, velocity, &gains);
+	uint16_t Servo_Command = steering_update(&steering, &gains, LINEFIND_Q8(desired_center), line_position.center_q8, timestamp_us);
+
+	Servo_SetDutyUS(Servo_Command);
+	servo_command = Servo_Command;
+	trace(Trace_Steer, line_position.center_q8 >> 8, Servo_Command);
+	error_q8_prev = error_q8;
+	return TRUE;
+}
+
+// Velocity watchdog and the desired velocity for the speed loop
+static void velocity_update_desired(uint32_t timestamp_us)
+{
+	// Velocity detecting stuff
+	// Signed, a capture can land after the frame was stamped
+	if ((int32_t)(timestamp_us - velocity_update_us) > VELOCITY_TIMEOUT_US) {
+		// If it has been too long since an update to velocity, it's stopped
+		velocity = 0;
+	}
+	// Update desired velocity, from the last frame that had a line
+	PlannerGains_t gains = {
+		.velocity_max = params.velocity_max,
+		.lateral_accel = params.Lateral_Accel,
+		.decel = params.Decel,
+		.accel = params.Accel,
+		.servo_center = params.Servo_Center,
+		.servo_left = params.Servo_Left,
+	};
+	velocity_desired = planner_update(&planner, &gains, -error_q8_prev, servo_command, timestamp_us);
+}
+
+// Speed loop, speed_update decides when it is due
+static void motors_update(uint32_t timestamp_us)
+{
+	SpeedGains_t gains = {
+		.kp = params.Kpv,
+		.ki = params.Kiv,
+		.duty_max = params.Duty_Max,
+		.brake_max = params.Brake_Max,
+		.brake = SPEED_BRAKE,
+	};
+#if MOTORS_SHAPE
+	MotorLimits_t limits = {
+		.rise = params.Motor_Rise,
+		.fall = params.Motor_Fall,
+		.jerk = params.Motor_Jerk,
+		.brake_rise = params.Brake_Rise,
+		.brake = params.Brake_Max,
+	};
+	motors_set_limits(&limits);
+#endif
+	SpeedCommand_t command;
+	if (speed_update(&speed, &gains, velocity_desired, velocity, timestamp_us, &command)) {
+		motors_set_differential(command.direction, command.duty, planner.curvature_now, velocity, params.Diff_Gain);
+		trace(Trace_Speed, command.direction, command.duty);
+	}
+}
+
+// Sends every telemetry channel the host subscribed to that is due this frame
+static void telemetry_update(uint32_t timestamp_us, const uint16_t *frame, uint16_t threshold)
+{
+	uint16_t due = telemetry_frame_due();
+	int16_t velocity_q8 = q16_to_q8(velocity); // Pins at +-128 inches per second
+	int16_t velocity_desired_q8 = q16_to_q8(velocity_desired);
+
+	if (due & TELEM_CHANNEL_BIT(TelemChannel_Status)) {
+		TelemStatus_t status;
+		status.timestamp_us = timestamp_us;
+		status.frame = linecam_frame_count;
+		status.line_center_q8 = line_position.center_q8;
+		status.error_q8 = error_q8_prev;
+		status.servo_us = servo_command;
+		status.velocity_q8 = velocity_q8;
+		status.velocity_desired_q8 = velocity_desired_q8;
+		status.motor_duty = motors_get_duty();
+		status.threshold = threshold;
+		status.exposure_us = linecam_exposure_us;
+		status.line_class = line_scene.type;
+		status.line_confidence = line_position.confidence;
+		telemetry_send(TelemType_Status, &status, sizeof(status));
+	}
+	if (due & TELEM_CHANNEL_BIT(TelemChannel_RawFrame)) {
+		telemetry_send_gray(timestamp_us, frame);
+	}
+	if (due & TELEM_CHANNEL_BIT(TelemChannel_BinaryFrame)) {
+		telemetry_send_binary(timestamp_us, pixel_bits);
+	}
+	if (due & TELEM_CHANNEL_BIT(TelemChannel_DeltaFrame)) {
+		telemetry_send_delta(timestamp_us, pixel_bits);
+	}
+
+	// Same order as TelemChannel_t
+	const uint16_t samples[TelemChannel_Count - TELEM_FIRST_SAMPLE] = {
+		line_position.center_q8,
+		error_q8_prev,
+		servo_command,
+		velocity_q8,
+		velocity_desired_q8,
+		motors_get_duty(),
+	};
+	telemetry_send_samples(timestamp_us, due, samples);
+}
+
 /* END Events */
 
 #ifdef __cplusplus
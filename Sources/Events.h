@@ -16,6 +16,7 @@
 **         SI_Timer_OnInterrupt - void SI_Timer_OnInterrupt(void);
 **         AO_OnEnd             - void AO_OnEnd(void);
 **         AO_OnCalibrationEnd  - void AO_OnCalibrationEnd(void);
+**         LineCam_OnFrame      - void LineCam_OnFrame(const uint16_t *frame);
 **         Cpu_OnNMIINT         - void Cpu_OnNMIINT(void);
 **
 ** ###################################################################*/
@@ -168,6 +169,23 @@ void AO_OnCalibrationEnd(void);
 ** ===================================================================
 */
 
+/*
+** ===================================================================
+**     Event       :  LineCam_OnFrame (module Events)
+**
+**     Component   :  LineCamera [DMA]
+**     Description :
+**         This event is called from linecam_poll in the main loop
+**         for every new frame. The frame stays untouched by
+**         acquisition until the event returns.
+**     Parameters  :
+**         NAME            - DESCRIPTION
+**       * frame           - Pointer to LINECAM_PIXELS raw ADC samples
+**     Returns     : Nothing
+** ===================================================================
+*/
+void LineCam_OnFrame(const uint16_t *frame);
+
 /*
 ** ===================================================================
 **     Event       :  Cpu_OnNMIINT (module Events)
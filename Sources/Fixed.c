@@ -0,0 +1,105 @@
+/*
+ * Fixed.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "Fixed.h"
+
+// Private variables
+// 2^16 / m for m = 1 + (i + 0.5) / 128, seeds one Newton step in q16_div
+static const uint16_t reciprocal[128] = {
+	65281, 64777, 64281, 63792, 63310, 62836, 62369, 61909, 61455, 61008, 60568, 60133, 59705, 59283, 58867, 58457,
+	58053, 57654, 57260, 56872, 56489, 56111, 55738, 55370, 55007, 54649, 54295, 53946, 53601, 53261, 52925, 52593,
+	52265, 51942, 51622, 51306, 50995, 50686, 50382, 50081, 49784, 49490, 49200, 48913, 48630, 48349, 48072, 47798,
+	47528, 47260, 46995, 46733, 46474, 46218, 45965, 45714, 45467, 45222, 44979, 44739, 44502, 44267, 44035, 43805,
+	43577, 43352, 43129, 42908, 42690, 42474, 42260, 42048, 41838, 41631, 41425, 41222, 41020, 40820, 40623, 40427,
+	40233, 40041, 39851, 39662, 39476, 39291, 39108, 38926, 38746, 38568, 38392, 38217, 38044, 37872, 37702, 37533,
+	37366, 37200, 37036, 36873, 36712, 36552, 36393, 36236, 36080, 35926, 35772, 35620, 35470, 35320, 35172, 35026,
+	34880, 34735, 34592, 34450, 34309, 34169, 34031, 33893, 33757, 33622, 33487, 33354, 33222, 33091, 32961, 32832,
+};
+
+// Private function declarations
+static uint32_t q16_reciprocal(uint32_t den, int *shift);
+
+// Public function definitions
+// num / den in Q16 through a reciprocal table, no division instruction on the M0+.
+// 14 significant bits, relative error under 2^-14 (see Tools/fixedcheck), saturates on overflow and on den == 0.
+Q16_t q16_div(int32_t num, int32_t den) {
+	bool negative = (num < 0) != (den < 0);
+	uint32_t n = (num < 0) ? -(uint32_t)num : (uint32_t)num;
+	uint32_t d = (den < 0) ? -(uint32_t)den : (uint32_t)den;
+
+	if (d == 0) {
+		return negative ? Q16_MIN : Q16_MAX;
+	}
+	int shift;
+	uint64_t r = q16_reciprocal(d, &shift);
+	// n / d = n * r * 2^(shift - 47), and the result is wanted * 2^16
+	uint64_t q = (uint64_t)n * r;
+	int right = 31 - shift;
+	q = (right >= 0) ? (q + ((uint64_t)1 << right >> 1)) >> right : q << -right;
+	if (q > (uint64_t)Q16_MAX) {
+		return negative ? Q16_MIN : Q16_MAX;
+	}
+	return negative ? -(Q16_t)q : (Q16_t)q;
+}
+
+// Square root of a non-negative value, bit by bit over the 48 bit radicand. Negative gives 0.
+Q16_t q16_sqrt(Q16_t value) {
+	if (value <= 0) {
+		return 0;
+	}
+	uint64_t x = (uint64_t)value << 16;
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 46;
+	while (bit > x) {
+		bit >>= 2;
+	}
+	while (bit) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (Q16_t)root;
+}
+
+Q16_t q16_from_float(float value) {
+	float scaled = value * 65536.0f;
+	if (scaled >= 2147483647.0f) {
+		return Q16_MAX;
+	}
+	if (scaled <= -2147483648.0f) {
+		return Q16_MIN;
+	}
+	return (Q16_t)(scaled + (scaled >= 0 ? 0.5f : -0.5f));
+}
+
+float q16_to_float(Q16_t value) {
+	return value / 65536.0f;
+}
+
+// Private function definitions
+// 1 / den = r * 2^(shift - 47), r in [2^15, 2^16]. No CLZ on the M0+, normalise by halving steps.
+static uint32_t q16_reciprocal(uint32_t den, int *shift) {
+	int s = 0;
+	if (!(den & 0xFFFF0000u)) { den <<= 16; s += 16; }
+	if (!(den & 0xFF000000u)) { den <<= 8; s += 8; }
+	if (!(den & 0xF0000000u)) { den <<= 4; s += 4; }
+	if (!(den & 0xC0000000u)) { den <<= 2; s += 2; }
+	if (!(den & 0x80000000u)) { den <<= 1; s += 1; }
+	*shift = s;
+
+	// den is now m * 2^31 with m in [1, 2)
+	uint32_t m = den >> 16;							// Q15, [32768, 65536)
+	uint32_t r = reciprocal[(den >> 24) & 0x7F];	// Q16, 1 / m
+	uint32_t e = (m * r) >> 16;						// Q15, m * r close to 1
+	r = (r * (65536u - e)) >> 15;					// r * (2 - m * r)
+	return r;
+}
@@ -0,0 +1,90 @@
+/*
+ * Fixed.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_FIXED_H_
+#define SOURCES_FIXED_H_
+
+#include "PE_Types.h"
+
+// Fixed point for the control paths, the M0+ has no FPU and soft doubles cost
+// hundreds to thousands of cycles. Everything saturates instead of wrapping.
+//   Q16_t: Q16.16, +-32768 with 1/65536 resolution, gains, speeds, pixels
+//   Q15_t: Q1.15, [-1, 1), ratios and filter coefficients
+
+// Public typedefs
+typedef int32_t Q16_t;
+typedef int16_t Q15_t;
+
+// Public defines
+#define Q16_ONE ((Q16_t)1 << 16)
+#define Q16_MAX INT32_MAX
+#define Q16_MIN INT32_MIN
+#define Q15_ONE INT16_MAX			// 1 - 2^-15, as close to 1 as Q15 gets.
+#define Q15_MAX INT16_MAX
+#define Q15_MIN INT16_MIN
+// Compile time constants only, x has to fold to a constant or this pulls in soft float
+#define Q16(x) ((Q16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q15(x) ((Q15_t)((x) >= 1.0 ? Q15_ONE : (x) * 32768.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q16_FROM_INT(i) ((Q16_t)(i) << 16)
+
+// Public functions
+Q16_t q16_div(int32_t num, int32_t den);
+Q16_t q16_sqrt(Q16_t value);
+Q16_t q16_from_float(float value);		// Outside the control paths only.
+float q16_to_float(Q16_t value);
+
+static inline Q16_t q16_sat(int64_t value) {
+	return (value > Q16_MAX) ? Q16_MAX : (value < Q16_MIN) ? Q16_MIN : (Q16_t)value;
+}
+
+static inline Q16_t q16_add(Q16_t a, Q16_t b) {
+	return q16_sat((int64_t)a + b);
+}
+
+static inline Q16_t q16_sub(Q16_t a, Q16_t b) {
+	return q16_sat((int64_t)a - b);
+}
+
+static inline Q16_t q16_mul(Q16_t a, Q16_t b) {
+	return q16_sat(((int64_t)a * b) >> 16);
+}
+
+// Rounds to the nearest integer, halves away from zero
+static inline int32_t q16_round(Q16_t value) {
+	return (value >= 0) ? (int32_t)(((int64_t)value + 0x8000) >> 16) : -(int32_t)(((int64_t)-(int64_t)value + 0x8000) >> 16);
+}
+
+static inline Q15_t q15_sat(int32_t value) {
+	return (value > Q15_MAX) ? Q15_MAX : (value < Q15_MIN) ? Q15_MIN : (Q15_t)value;
+}
+
+// Q8.8 in an int16_t, saturated, for telemetry fields
+static inline int16_t q16_to_q8(Q16_t value) {
+	value >>= 8;
+	return (value > INT16_MAX) ? INT16_MAX : (value < INT16_MIN) ? INT16_MIN : (int16_t)value;
+}
+
+static inline Q15_t q15_add(Q15_t a, Q15_t b) {
+	return q15_sat((int32_t)a + b);
+}
+
+static inline Q15_t q15_mul(Q15_t a, Q15_t b) {
+	return q15_sat(((int32_t)a * b + 0x4000) >> 15);
+}
+
+// Scales a Q16 value by a Q15 ratio
+static inline Q16_t q16_scale(Q16_t a, Q15_t ratio) {
+	return (Q16_t)(((int64_t)a * ratio) >> 15);
+}
+
+// First order low pass, returns prev + alpha * (in - prev). The difference is kept in 64 bits,
+// saturating it would pull the result the wrong way for inputs more than 32768 apart.
+static inline Q16_t q16_lerp(Q16_t prev, Q16_t in, Q15_t alpha) {
+	return q16_sat((int64_t)prev + ((((int64_t)in - prev) * alpha) >> 15));
+}
+
+#endif /* SOURCES_FIXED_H_ */
@@ -0,0 +1,48 @@
+/*
+ * Flash.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "Cpu.h"
+#include "Flash.h"
+#include "FTFA_PDD.h"
+
+// Private variables
+#define FLASH_ERRORS (FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK | FTFA_FSTAT_MGSTAT0_MASK)
+
+// Private function declarations
+// The flash can't be read while a command runs, so the launch loop has to live in RAM.
+// Startup copies .data* to RAM, long_call because RAM is out of BL range from flash.
+static uint8_t flash_launch(void) __attribute__((section(".data.flash_launch"), long_call, noinline));
+
+// Public function definitions
+bool flash_erase_sector(uint32_t address) {
+	while (!FTFA_PDD_GetCmdCompleteFlag(FTFA_BASE_PTR)) {}
+	FTFA_PDD_ClearErrorFlags(FTFA_BASE_PTR);
+	FTFA_PDD_Cmd_EraseSector_Init(FTFA_BASE_PTR, address);
+	return flash_launch() == 0;
+}
+
+bool flash_program(uint32_t address, const uint32_t *data, uint16_t words) {
+	for (uint16_t i = 0; i < words; ++i) {
+		while (!FTFA_PDD_GetCmdCompleteFlag(FTFA_BASE_PTR)) {}
+		FTFA_PDD_ClearErrorFlags(FTFA_BASE_PTR);
+		FTFA_PDD_Cmd_ProgramLongword_Init(FTFA_BASE_PTR, address + 4 * i, data[i]);
+		if (flash_launch() != 0) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+// Private function definitions
+// Runs the command loaded into FCCOB with interrupts off (the vector table is in flash too)
+static uint8_t flash_launch(void) {
+	EnterCritical();
+	FTFA_PDD_StartCmd(FTFA_BASE_PTR);
+	while (!FTFA_PDD_GetCmdCompleteFlag(FTFA_BASE_PTR)) {}
+	ExitCritical();
+	return FTFA_PDD_GetFlags(FTFA_BASE_PTR) & FLASH_ERRORS;
+}
@@ -0,0 +1,22 @@
+/*
+ * Flash.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_FLASH_H_
+#define SOURCES_FLASH_H_
+
+#include "PE_Types.h"
+
+// Public defines
+#define FLASH_SECTOR_SIZE 0x400
+// Last program flash sector, kept out of m_text in ProcessorExpert.ld
+#define FLASH_USER_SECTOR 0x0001FC00u
+
+// Public functions
+bool flash_erase_sector(uint32_t address);
+bool flash_program(uint32_t address, const uint32_t *data, uint16_t words);
+
+#endif /* SOURCES_FLASH_H_ */
@@ -0,0 +1,71 @@
+/*
+ * FrameDelta.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include <string.h>
+#include "FrameDelta.h"
+#include "LineFinder.h"
+
+// Public function definitions
+// Encodes the frame as changes in its edge positions, with a keyframe every TELEM_KEYFRAME_EVERY.
+// Fills packet, returns its type and puts the payload size in length.
+TelemType_t framedelta_encode(FrameDelta_t *encoder, uint32_t timestamp_us, const uint32_t *bits, FrameDeltaPacket_t *packet, uint8_t *length) {
+	uint8_t edges[TELEM_DELTA_MAX_EDGES + 1];
+	uint8_t count = linefind_edges(bits, 0, LINECAM_PIXELS, edges, TELEM_DELTA_MAX_EDGES + 1);
+	uint32_t dt_us = timestamp_us - encoder->prev_us;
+	TelemType_t type;
+
+	encoder->index++;
+	if (encoder->until_key == 0 || count > TELEM_DELTA_MAX_EDGES || dt_us > 0xFFFF) {
+		packet->key.timestamp_us = timestamp_us;
+		packet->key.index = encoder->index;
+		memcpy(packet->key.bits, bits, TELEM_BINARY_BYTES); // Little-endian words are already pixel ordered bytes
+		*length = sizeof(packet->key);
+		encoder->until_key = TELEM_KEYFRAME_EVERY;
+		type = TelemType_FrameKey;
+	}
+	else {
+		TelemFrameDelta_t *delta = &packet->delta;
+		uint8_t data_length = count;
+		delta->index = encoder->index;
+		delta->dt_us = dt_us;
+		delta->count = count;
+		bool small = (count == encoder->prev_count);
+		for (int i = 0; i < count && small; ++i) {
+			int8_t move = edges[i] - encoder->prev[i];
+			small = (move >= -8 && move <= 7);
+		}
+		if (small) {
+			delta->count |= TELEM_DELTA_NIBBLES;
+			data_length = (count + 1) / 2;
+			memset(delta->data, 0, data_length);
+			for (int i = 0; i < count; ++i) {
+				delta->data[i / 2] |= ((uint8_t)(edges[i] - encoder->prev[i]) & 0x0F) << ((i & 1) * 4);
+			}
+		}
+		else {
+			memcpy(delta->data, edges, count);
+		}
+		*length = sizeof(*delta) - sizeof(delta->data) + data_length;
+		encoder->until_key--;
+		type = TelemType_FrameDelta;
+	}
+
+	if (count <= TELEM_DELTA_MAX_EDGES) {
+		memcpy(encoder->prev, edges, count);
+		encoder->prev_count = count;
+	}
+	else {
+		encoder->prev_count = 0xFF; // Too many edges to keep, the next frame goes out as absolute edges
+	}
+	encoder->prev_us = timestamp_us;
+	return type;
+}
+
+// The last packet never went out, the host lost track and needs a keyframe
+void framedelta_lost(FrameDelta_t *encoder) {
+	encoder->until_key = 0;
+}
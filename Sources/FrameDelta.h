@@ -0,0 +1,35 @@
+/*
+ * FrameDelta.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_FRAMEDELTA_H_
+#define SOURCES_FRAMEDELTA_H_
+
+#include "PE_Types.h"
+#include "TelemetryFormat.h"
+
+// Binary frames as TelemFrameKey_t and TelemFrameDelta_t packets. No hardware in here,
+// Tools/telemrec builds this file as it is for its synthetic stream.
+
+// Public typedefs
+typedef struct FrameDelta_t {
+	uint8_t prev[TELEM_DELTA_MAX_EDGES];	// Edges of the last frame
+	uint8_t prev_count;						// 0xFF when it had too many to keep
+	uint16_t index;
+	uint32_t prev_us;
+	uint8_t until_key;						// Deltas left before the next keyframe, 0 = keyframe next
+} FrameDelta_t;								// All zeros is a valid start
+
+typedef union FrameDeltaPacket_t {
+	TelemFrameKey_t key;
+	TelemFrameDelta_t delta;
+} FrameDeltaPacket_t;
+
+// Public functions
+TelemType_t framedelta_encode(FrameDelta_t *encoder, uint32_t timestamp_us, const uint32_t *bits, FrameDeltaPacket_t *packet, uint8_t *length);
+void framedelta_lost(FrameDelta_t *encoder);
+
+#endif /* SOURCES_FRAMEDELTA_H_ */
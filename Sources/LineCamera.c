@@ -0,0 +1,465 @@
+/*
+ * LineCamera.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include <stddef.h>
+#include "Cpu.h"
+#include "LineCamera.h"
+#include "Flash.h"
+#include "Trace.h"
+#include "Vectors.h"
+#include "Timebase.h"
+
+// Public variables
+volatile uint32_t linecam_frame_count = 0;
+volatile uint32_t linecam_dropped_frames = 0;
+volatile uint16_t linecam_threshold_value = LINECAM_DEFAULT_THRESHOLD;
+volatile uint16_t linecam_exposure_us = LINECAM_EXPOSURE_MIN_US;
+volatile bool linecam_calibrated = FALSE;
+
+// Private variables
+#define ADC0_TRGSEL_TPM1_OVF 9	// SIM_SOPT7 ADC0TRGSEL value for a TPM1 overflow trigger
+#define DMAMUX_SRC_ADC0 40		// DMAMUX request source for ADC0 conversion complete
+#define ADC0_CHANNEL 0			// ADC0_SE0, the pin AO is configured for
+#define NO_BUFFER -1
+#define HIST_SHIFT 10			// 16 bit samples -> 64 histogram bins
+#define HIST_BINS (65536 >> HIST_SHIFT)
+
+// Ping-pong frame buffers. Only one side touches a buffer at a time:
+// frames[filling] belongs to acquisition, frames[busy] to the consumer, frames[ready] to nobody.
+static volatile uint16_t frames[2][LINECAM_PIXELS];
+static volatile int8_t filling = 0;
+static volatile int8_t ready = NO_BUFFER;
+static volatile int8_t busy = NO_BUFFER;
+static volatile uint16_t frame_exposure_us[2];	// Exposure each buffer's frame was integrated with
+
+// SI pulse sequencer on SI_Timer (PIT channel 0): wait, raise SI, drop SI and start the readout
+typedef enum SIState_t {
+	SIState_Idle,
+	SIState_Wait,
+	SIState_High,
+} SIState_t;
+static volatile SIState_t si_state = SIState_Idle;
+static volatile uint16_t si_exposure_us = LINECAM_EXPOSURE_MIN_US;	// Exposure that ends at the pending SI
+static uint32_t pit_ticks_per_us = 1;
+
+// Flat-field table as stored in FLASH_USER_SECTOR
+#define CAL_MAGIC 0x4C43414Cu	// "LCAL"
+#define CAL_GAIN_SHIFT 12		// gain is Q4.12
+typedef struct LineCamCal_t {
+	uint32_t magic;
+	uint16_t dark[LINECAM_PIXELS];
+	uint16_t gain[LINECAM_PIXELS];
+	uint32_t checksum;
+} LineCamCal_t;
+#define CAL_WORDS (sizeof(LineCamCal_t) / sizeof(uint32_t))
+static const LineCamCal_t * const cal_flash = (const LineCamCal_t *)FLASH_USER_SECTOR;
+static const LineCamCal_t * volatile cal_active = NULL; // Table applied in linecam_frame_done
+static LineCamCal_t cal_new;							// Built here, then copied to flash
+
+// Private function declarations
+static void linecam_arm_dma(void);
+static void linecam_si_schedule(uint32_t wait_us);
+static void linecam_si_load(uint32_t us);
+static void linecam_flat_field(volatile uint16_t *frame, const LineCamCal_t *cal);
+static uint32_t linecam_cal_checksum(const LineCamCal_t *cal);
+static uint16_t linecam_cal_frame(uint16_t *average, uint8_t shift, bool expose);
+static void linecam_cal_average(uint16_t *average);
+static uint16_t linecam_otsu(const uint16_t *frame);
+
+// Public function definitions
+void linecam_init(void) {
+	// SI_Timer comes up with the Processor Expert period, work out the PIT clock from it
+	pit_ticks_per_us = (PIT_LDVAL0 + 1) / LINECAM_PE_SI_PERIOD_US;
+	if (pit_ticks_per_us == 0) {
+		pit_ticks_per_us = 1;
+	}
+#if LINECAM_USE_DMA
+	// Stop the per-pixel Clk_OnEnd interrupt, the overflow now only triggers the ADC
+	TPM1_SC &= ~TPM_SC_TOIE_MASK;
+	// Speed up the camera clock, MOD is double buffered so this lands on the next period
+	uint32_t mod = ((uint32_t)(TPM1_MOD + 1) * LINECAM_CLK_PERIOD_US) / LINECAM_PE_CLK_PERIOD_US;
+	TPM1_MOD = mod - 1;
+	TPM1_C0V = mod / 2;
+
+	// Let TPM1 overflow start the conversion and have the result request DMA
+	ADC0_SC1A = ADC_SC1_ADCH(ADC0_CHANNEL); // No AIEN, AO_OnEnd is not used in this mode
+	SIM_SOPT7 = SIM_SOPT7_ADC0ALTTRGEN_MASK | SIM_SOPT7_ADC0TRGSEL(ADC0_TRGSEL_TPM1_OVF);
+	ADC0_SC2 |= ADC_SC2_ADTRG_MASK | ADC_SC2_DMAEN_MASK;
+
+	// DMA channel 0: 16 bit ADC0_RA -> 16 bit frames[filling][i++], one transfer per request
+	SIM_SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+	SIM_SCGC7 |= SIM_SCGC7_DMA_MASK;
+	DMAMUX0_CHCFG0 = 0;
+	DMA_DCR0 = DMA_DCR_EINT_MASK | DMA_DCR_CS_MASK | DMA_DCR_DINC_MASK
+			 | DMA_DCR_SSIZE(2) | DMA_DCR_DSIZE(2) | DMA_DCR_D_REQ_MASK;
+	DMAMUX0_CHCFG0 = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(DMAMUX_SRC_ADC0);
+
+	vectors_set(INT_DMA0, linecam_dma_isr);
+	NVIC_ICPR = 1u << (INT_DMA0 - 16);
+	NVIC_ISER = 1u << (INT_DMA0 - 16);
+#endif
+}
+
+// Pulses SI as soon as possible, the readout starts when it drops again
+void linecam_start_frame(void) {
+	si_exposure_us = linecam_exposure_us;
+	linecam_si_schedule(0);
+}
+
+// Called from SI_Timer_OnInterrupt
+void linecam_on_si_timer(void) {
+	switch (si_state) {
+	case SIState_Wait:
+		SI_SetVal();
+		linecam_si_load(LINECAM_SI_HIGH_US);
+		si_state = SIState_High;
+		break;
+
+	case SIState_High:
+		SI_ClrVal();
+		SI_Timer_Disable();
+		si_state = SIState_Idle;
+		frame_exposure_us[filling] = si_exposure_us; // The frame read out now
+#if LINECAM_USE_DMA
+		linecam_arm_dma();
+#endif
+		break;
+
+	default: // Stray interrupt
+		SI_Timer_Disable();
+		break;
+	}
+}
+
+// Legacy path, AO_OnEnd hands over one pixel at a time
+void linecam_store_pixel(uint16_t index, uint16_t value) {
+	if (index < LINECAM_PIXELS) {
+		frames[filling][index] = value;
+	}
+}
+
+// Called from interrupt context once frames[filling] holds a whole frame
+void linecam_frame_done(void) {
+	int8_t done = filling;
+	int8_t other = done ^ 1;
+	linecam_frame_count++;
+
+	if (cal_active != NULL) {
+		linecam_flat_field(frames[done], cal_active);
+	}
+
+	if (busy == other) {
+		// The consumer still holds the other buffer, nowhere to put the next frame
+		linecam_dropped_frames++;
+		return;
+	}
+	if (ready == other) {
+		// The consumer never picked up the previous frame
+		linecam_dropped_frames++;
+	}
+	ready = done;
+	filling = other;
+}
+
+// Takes the newest complete frame, NULL if there is none. Hand it back with linecam_release.
+const uint16_t *linecam_acquire(void) {
+	const uint16_t *frame = NULL;
+
+	EnterCritical();
+	if (ready != NO_BUFFER) {
+		busy = ready;
+		ready = NO_BUFFER;
+		frame = (const uint16_t *)frames[busy];
+	}
+	ExitCritical();
+	return frame;
+}
+
+void linecam_release(void) {
+	busy = NO_BUFFER;
+}
+
+// Main loop side of the pipeline, runs LineCam_OnFrame on each new frame
+void linecam_poll(void) {
+	const uint16_t *frame = linecam_acquire();
+	if (frame != NULL) {
+		LineCam_OnFrame(frame);
+		linecam_release();
+	}
+}
+
+// Loads the flat-field table from flash, or captures a new one if the lens is covered at boot.
+// Covered means dark even at the longest exposure, a dim hall never gets that far. Gives up and
+// keeps the stored table if the lens isn't uncovered in time.
+// Call once after timebase_init and linecam_start_frame, before the main loop starts polling.
+void linecam_cal_boot(void) {
+	// Checking the stored table is one pass over 130 words straight out of flash
+	const LineCamCal_t *stored = NULL;
+	if (cal_flash->magic == CAL_MAGIC && cal_flash->checksum == linecam_cal_checksum(cal_flash)) {
+		stored = cal_flash;
+	}
+
+	cal_active = stored;
+	linecam_calibrated = (stored != NULL);
+	if (linecam_cal_frame(NULL, 0, FALSE) >= LINECAM_CAL_DARK_MAX) {
+		return; // Lens not covered, normal boot
+	}
+
+	// Still dark with the longest exposure, frame after frame?
+	uint16_t exposure = linecam_exposure_us;
+	linecam_exposure_us = LINECAM_EXPOSURE_MAX_US;
+	linecam_cal_frame(NULL, 0, FALSE); // Already started with the old exposure
+	bool covered = TRUE;
+	for (int n = 0; covered && n < LINECAM_CAL_TRIGGER_FRAMES; ++n) {
+		covered = linecam_cal_frame(NULL, 0, FALSE) < LINECAM_CAL_DARK_MAX;
+	}
+	linecam_exposure_us = exposure;
+	linecam_cal_frame(NULL, 0, FALSE);
+	if (!covered) {
+		return;
+	}
+
+	// Dark reference while the lens is still covered, without the flat field
+	cal_active = NULL;
+	linecam_cal_average(cal_new.dark);
+
+	// White reference once the lens is uncovered, with the exposure settled on the white floor
+	uint32_t start_us = timebase_us();
+	while (linecam_cal_frame(NULL, 0, TRUE) < LINECAM_CAL_WHITE_MIN) {
+		if (timebase_us() - start_us > LINECAM_CAL_UNCOVER_US) {
+			cal_active = stored; // Never uncovered, keep what we had
+			return;
+		}
+	}
+	start_us = timebase_us();
+	while (timebase_us() - start_us < LINECAM_CAL_SETTLE_US) {
+		linecam_cal_frame(NULL, 0, TRUE);
+	}
+	linecam_cal_average(cal_new.gain);
+
+	// Turn the white reference into gains in place
+	for (int i = 0; i < LINECAM_PIXELS; ++i) {
+		uint32_t white = cal_new.gain[i] > cal_new.dark[i] ? cal_new.gain[i] - cal_new.dark[i] : 0;
+		uint32_t gain = 1u << CAL_GAIN_SHIFT; // Dead pixel, leave it alone
+		if (white > 0x100) {
+			gain = ((uint32_t)LINECAM_CAL_WHITE_TARGET << CAL_GAIN_SHIFT) / white;
+			if (gain > 0xFFFF) gain = 0xFFFF;
+		}
+		cal_new.gain[i] = gain;
+	}
+	cal_new.magic = CAL_MAGIC;
+	cal_new.checksum = linecam_cal_checksum(&cal_new);
+
+	if (flash_erase_sector(FLASH_USER_SECTOR)
+			&& flash_program(FLASH_USER_SECTOR, (const uint32_t *)&cal_new, CAL_WORDS)) {
+		cal_active = cal_flash;
+	}
+	else {
+		cal_active = &cal_new; // Still good for this run
+	}
+	linecam_calibrated = TRUE;
+}
+
+// Nudges the integration time so the brightest pixel of the next frames lands between
+// LINECAM_PEAK_LOW and LINECAM_PEAK_HIGH. Bright tracks get short frames, dim halls long ones.
+// frame has to be the one from linecam_acquire. A change only shows up one or two frames later,
+// frames from before it are skipped so the same error isn't corrected twice.
+void linecam_exposure_update(const uint16_t *frame) {
+	if (busy == NO_BUFFER || frame_exposure_us[busy] != linecam_exposure_us) {
+		return;
+	}
+
+	uint16_t peak = 0;
+	for (int i = 0; i < LINECAM_PIXELS; ++i) {
+		if (frame[i] > peak) peak = frame[i];
+	}
+	if (peak >= LINECAM_PEAK_LOW && peak <= LINECAM_PEAK_HIGH) {
+		return;
+	}
+
+	// Response is roughly linear in integration time, allow at most x2 or /2 per frame
+	uint32_t exposure = linecam_exposure_us;
+	if (peak < LINECAM_PEAK_TARGET / 2) {
+		exposure *= 2;
+	}
+	else if (peak >= LINECAM_PEAK_SATURATED) {
+		exposure /= 2; // Clipped, the ratio below would under-correct
+	}
+	else {
+		exposure = (exposure * LINECAM_PEAK_TARGET) / peak;
+	}
+
+	if (exposure < LINECAM_EXPOSURE_MIN_US) exposure = LINECAM_EXPOSURE_MIN_US;
+	if (exposure > LINECAM_EXPOSURE_MAX_US) exposure = LINECAM_EXPOSURE_MAX_US;
+	linecam_exposure_us = exposure;
+}
+
+// Picks the threshold for this frame and stores it in linecam_threshold_value
+uint16_t linecam_threshold(const uint16_t *frame) {
+#if LINECAM_THRESHOLD_MODE == LINECAM_THRESHOLD_FIXED
+	return linecam_threshold_value;
+#else
+	uint16_t min = 0xFFFF;
+	uint16_t max = 0;
+	for (int i = 0; i < LINECAM_PIXELS; ++i) {
+		if (frame[i] < min) min = frame[i];
+		if (frame[i] > max) max = frame[i];
+	}
+	if (max - min < LINECAM_MIN_CONTRAST) {
+		return linecam_threshold_value; // Nothing to split, don't chase noise
+	}
+#if LINECAM_THRESHOLD_MODE == LINECAM_THRESHOLD_MINMAX
+	linecam_threshold_value = min + ((max - min) >> 1);
+#else
+	linecam_threshold_value = linecam_otsu(frame);
+#endif
+	return linecam_threshold_value;
+#endif
+}
+
+// Packs frame into LINECAM_WORDS words, one bit per pixel, set where frame[i] >= threshold
+void linecam_binarize(const uint16_t *frame, uint16_t threshold, uint32_t *bits) {
+	for (int w = 0; w < LINECAM_WORDS; ++w) {
+		uint32_t word = 0;
+		for (int b = 31; b >= 0; --b) {
+			word = (word << 1) | (frame[b] >= threshold);
+		}
+		bits[w] = word;
+		frame += 32;
+	}
+}
+
+// Frame complete, DMA channel 0 has copied all LINECAM_PIXELS samples
+PE_ISR(linecam_dma_isr)
+{
+	DMA_DSR_BCR0 = DMA_DSR_BCR_DONE_MASK; // Clears the interrupt as well
+	trace(Trace_FrameDone, 0, linecam_frame_count);
+	linecam_frame_done();
+
+	// The last SI was one readout and one SI pulse ago, hold off until the exposure is up
+	si_exposure_us = linecam_exposure_us;
+	int32_t wait_us = (int32_t)si_exposure_us - LINECAM_READOUT_US - LINECAM_SI_HIGH_US;
+	linecam_si_schedule(wait_us > 0 ? wait_us : 0);
+}
+
+// Private function definitions
+static void linecam_arm_dma(void) {
+	DMA_DSR_BCR0 = DMA_DSR_BCR_DONE_MASK;
+	(void)ADC0_RA; // Drop a stale conversion so the first request is pixel 0
+	DMA_SAR0 = (uint32_t)&ADC0_RA;
+	DMA_DAR0 = (uint32_t)frames[filling];
+	DMA_DSR_BCR0 = DMA_DSR_BCR_BCR(LINECAM_PIXELS * sizeof(uint16_t));
+	DMA_DCR0 |= DMA_DCR_ERQ_MASK; // D_REQ clears this again once BCR reaches 0
+	trace(Trace_FrameStart, 0, linecam_frame_count);
+}
+
+// Raises SI after wait_us (at least one SI_HIGH period so the pulse shape stays the same)
+static void linecam_si_schedule(uint32_t wait_us) {
+	if (wait_us < LINECAM_SI_HIGH_US) {
+		wait_us = LINECAM_SI_HIGH_US;
+	}
+	si_state = SIState_Wait;
+	linecam_si_load(wait_us);
+}
+
+// Restarts SI_Timer with a new period, PIT only reloads LDVAL on its own at the next timeout
+static void linecam_si_load(uint32_t us) {
+	SI_Timer_Disable();
+	PIT_LDVAL0 = us * pit_ticks_per_us - 1;
+	SI_Timer_Enable();
+}
+
+// (raw - dark) * gain in Q4.12, saturated to 16 bits
+static void linecam_flat_field(volatile uint16_t *frame, const LineCamCal_t *cal) {
+	for (int i = 0; i < LINECAM_PIXELS; ++i) {
+		uint32_t value = frame[i];
+		value = value > cal->dark[i] ? value - cal->dark[i] : 0;
+		value = (value * cal->gain[i]) >> CAL_GAIN_SHIFT;
+		frame[i] = value > 0xFFFF ? 0xFFFF : value;
+	}
+}
+
+static uint32_t linecam_cal_checksum(const LineCamCal_t *cal) {
+	const uint32_t *word = (const uint32_t *)cal;
+	uint32_t sum = 0;
+	for (uint16_t i = 0; i < CAL_WORDS - 1; ++i) { // Everything but the checksum itself
+		sum = (sum << 1 | sum >> 31) + word[i];
+	}
+	return ~sum;
+}
+
+// Waits for the next raw frame, folds it into average with weight 1/2^shift and returns its peak.
+// expose runs the exposure control on it too.
+static uint16_t linecam_cal_frame(uint16_t *average, uint8_t shift, bool expose) {
+	const uint16_t *frame;
+	while ((frame = linecam_acquire()) == NULL) {}
+
+	uint16_t peak = 0;
+	for (int i = 0; i < LINECAM_PIXELS; ++i) {
+		if (frame[i] > peak) peak = frame[i];
+		if (average != NULL) {
+			int32_t diff = (int32_t)frame[i] - average[i];
+			average[i] += diff >> shift;
+		}
+	}
+	if (expose) {
+		linecam_exposure_update(frame);
+	}
+	linecam_release();
+	return peak;
+}
+
+// Exponential average (1/8 weight) over LINECAM_CAL_AVG_FRAMES frames, seeded with the first one
+static void linecam_cal_average(uint16_t *average) {
+	linecam_cal_frame(average, 0, FALSE);
+	for (int n = 1; n < LINECAM_CAL_AVG_FRAMES; ++n) {
+		linecam_cal_frame(average, 3, FALSE);
+	}
+}
+
+// Otsu's method on a 64 bin histogram, integer only.
+// Maximises (sum_b * N - sum * w_b)^2 / (w_b * w_f), the between-class variance scaled by N^2.
+static uint16_t linecam_otsu(const uint16_t *frame) {
+	uint8_t hist[HIST_BINS] = {0};
+	uint32_t sum = 0;
+	for (int i = 0; i < LINECAM_PIXELS; ++i) {
+		uint8_t bin = frame[i] >> HIST_SHIFT;
+		hist[bin]++;
+		sum += bin;
+	}
+
+	uint32_t w_b = 0;
+	uint32_t sum_b = 0;
+	uint32_t best_var = 0;
+	uint8_t best_bin = 0;
+	for (int t = 0; t < HIST_BINS - 1; ++t) {
+		if (hist[t] == 0) {
+			continue; // Same split as the previous bin
+		}
+		w_b += hist[t];
+		sum_b += t * hist[t];
+		uint32_t w_f = LINECAM_PIXELS - w_b;
+		if (w_f == 0) {
+			break;
+		}
+		int32_t diff = (int32_t)(sum_b * LINECAM_PIXELS) - (int32_t)(sum * w_b);
+		if (diff < 0) diff = -diff;
+		diff >>= 4; // |diff| < 2^20, keep the square in 32 bits
+		uint32_t var = ((uint32_t)diff * (uint32_t)diff) / (w_b * w_f);
+		if (var > best_var) {
+			best_var = var;
+			best_bin = t;
+		}
+	}
+	// Every split inside the empty gap after best_bin scores the same, take the middle of it
+	// so neither class sits right on the threshold
+	int next = best_bin + 1;
+	while (next < HIST_BINS - 1 && hist[next] == 0) {
+		next++;
+	}
+	return (uint16_t)(((best_bin + 1 + next) << HIST_SHIFT) / 2);
+}
@@ -0,0 +1,90 @@
+/*
+ * LineCamera.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_LINECAMERA_H_
+#define SOURCES_LINECAMERA_H_
+
+#include "PE_Types.h"
+#include "Events.h"
+
+// Config switches
+// 1: Clk (TPM1) overflow hardware-triggers AO (ADC0) and DMA channel 0 copies
+//    every sample into the frame buffer, one interrupt per frame.
+// 0: Legacy path, one Clk_OnEnd + one AO_OnEnd interrupt per pixel.
+// NOTE: linecam_init installs linecam_dma_isr for INT_DMA0, vectors_init has to run first.
+#define LINECAM_USE_DMA 1
+// Per-frame threshold: LINECAM_THRESHOLD_OTSU, LINECAM_THRESHOLD_MINMAX or LINECAM_THRESHOLD_FIXED
+#define LINECAM_THRESHOLD_MODE LINECAM_THRESHOLD_OTSU
+
+// Public defines
+#define LINECAM_PIXELS 128				// Pixels read out per frame.
+#define LINECAM_PE_CLK_PERIOD_US 1000	// Clk period configured in Processor Expert.
+#define LINECAM_PE_SI_PERIOD_US 350		// SI_Timer period configured in Processor Expert.
+#define LINECAM_PE_AO_CONV_NS 23126		// AO single-ended conversion time in Processor Expert (SingleConversionTimeSE).
+#define LINECAM_CLK_PERIOD_US 25		// Clk period used in DMA mode, 128 * 25us = 3.2ms per frame.
+#define LINECAM_READOUT_US (LINECAM_PIXELS * LINECAM_CLK_PERIOD_US)
+#if LINECAM_USE_DMA && LINECAM_CLK_PERIOD_US * 1000 < LINECAM_PE_AO_CONV_NS
+#error "Each Clk overflow triggers a conversion, LINECAM_CLK_PERIOD_US has to cover the AO conversion time"
+#endif
+#if LINECAM_USE_DMA
+#define LINECAM_SI_HIGH_US LINECAM_CLK_PERIOD_US	// SI has to see exactly one rising Clk edge.
+#else
+#define LINECAM_SI_HIGH_US LINECAM_PE_SI_PERIOD_US
+#endif
+
+// Exposure control (DMA mode only), integration time is the time between two SI pulses
+#define LINECAM_EXPOSURE_MIN_US (LINECAM_READOUT_US + 2 * LINECAM_SI_HIGH_US)	// Can't be shorter than a readout.
+#define LINECAM_EXPOSURE_MAX_US 20000
+#define LINECAM_PEAK_LOW 0xB000			// Keep the brightest pixel between these two.
+#define LINECAM_PEAK_HIGH 0xE800
+#define LINECAM_PEAK_TARGET ((LINECAM_PEAK_LOW + LINECAM_PEAK_HIGH) / 2)
+#define LINECAM_PEAK_SATURATED 0xFF00
+
+// Flat-field calibration, corrected = (raw - dark[i]) * gain[i] / 4096
+// Power up with the lens covered to (re)calibrate: the dark reference is taken while covered,
+// the white reference after the lens is uncovered over white floor. The table lives in flash.
+#define LINECAM_CAL_DARK_MAX 0x3000		// A covered lens reads below this everywhere.
+#define LINECAM_CAL_TRIGGER_FRAMES 8	// Frames at LINECAM_EXPOSURE_MAX_US that have to stay dark to start.
+#define LINECAM_CAL_WHITE_MIN 0x8000	// Peak that counts as uncovered.
+#define LINECAM_CAL_WHITE_TARGET 0xE000	// Level a white pixel is scaled to.
+#define LINECAM_CAL_UNCOVER_US 10000000	// Give up and keep the stored table if still covered after this.
+#define LINECAM_CAL_SETTLE_US 1000000	// Time to move the hand away and settle the exposure.
+#define LINECAM_CAL_AVG_FRAMES 32		// Frames folded into each reference.
+#define LINECAM_WORDS (LINECAM_PIXELS / 32)	// 32 bit words in a packed binary frame.
+#define LINECAM_DEFAULT_THRESHOLD ((uint16_t)((2.5 / 3.3) * 65535))	// 2.5V, used until a frame has enough contrast.
+#define LINECAM_MIN_CONTRAST 0x1000		// Below this max - min the frame is all line or all floor, keep the old threshold.
+
+#define LINECAM_THRESHOLD_FIXED 0
+#define LINECAM_THRESHOLD_MINMAX 1
+#define LINECAM_THRESHOLD_OTSU 2
+
+// Packed binary frame access, bit (i % 32) of word (i / 32) is set for a white pixel i
+#define LINECAM_BIT(bits, i) (((bits)[(i) >> 5] >> ((i) & 31)) & 1u)
+
+// Public variables
+extern volatile uint32_t linecam_frame_count;		// Frames completed since linecam_init.
+extern volatile uint32_t linecam_dropped_frames;	// Frames the consumer never got to see.
+extern volatile uint16_t linecam_threshold_value;	// Threshold picked for the last frame (telemetry).
+extern volatile uint16_t linecam_exposure_us;		// Time between SI pulses.
+extern volatile bool linecam_calibrated;			// A flat-field table is being applied.
+
+// Public functions
+void linecam_init(void);
+void linecam_start_frame(void);
+void linecam_on_si_timer(void);
+void linecam_store_pixel(uint16_t index, uint16_t value);
+void linecam_frame_done(void);
+const uint16_t *linecam_acquire(void);
+void linecam_release(void);
+void linecam_poll(void);
+void linecam_cal_boot(void);
+void linecam_exposure_update(const uint16_t *frame);
+uint16_t linecam_threshold(const uint16_t *frame);
+void linecam_binarize(const uint16_t *frame, uint16_t threshold, uint32_t *bits);
+PE_ISR(linecam_dma_isr);
+
+#endif /* SOURCES_LINECAMERA_H_ */
@@ -0,0 +1,208 @@
+/*
+ * LineFinder.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "LineFinder.h"
+
+// Private variables
+#define WEIGHT_SHIFT 4	// Darkness is 16 bit, 12 bits of it keep every sum below in 32 bits
+
+// Cortex-M0+ has no CLZ/RBIT, count trailing zeros of a single set bit with a de Bruijn multiply
+static const uint8_t debruijn_ctz[32] = {
+	0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+	31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9,
+};
+#define linefind_ctz(single_bit) (debruijn_ctz[((uint32_t)(single_bit) * 0x077CB531u) >> 27])
+
+// Public function definitions
+// Edge list of the packed frame: every pixel i in [from, to) that differs from pixel i - 1
+// (pixel -1 counts as white, so the first edge always starts a dark run). All 32 pixels of a word
+// are compared at once by XOR-ing the word with itself shifted by one. Returns the edge count.
+uint8_t linefind_edges(const uint32_t *bits, uint8_t from, uint8_t to, uint8_t *edges, uint8_t max) {
+	uint8_t count = 0;
+	if (from >= to) {
+		return 0;
+	}
+
+	for (int w = from >> 5; w <= (to - 1) >> 5; ++w) {
+		uint32_t word = bits[w];
+		uint32_t carry = (w == 0) ? 1u : bits[w - 1] >> 31;
+		uint32_t diff = word ^ ((word << 1) | carry);
+
+		// Keep only the edges inside [from, to)
+		int lo = from - w * 32;
+		int hi = to - w * 32;
+		if (lo > 0) diff &= ~0u << lo;
+		if (hi < 32) diff &= ~(~0u << hi);
+
+		while (diff != 0) {
+			if (count >= max) {
+				return count;
+			}
+			uint32_t lowest = diff & (0u - diff);
+			edges[count++] = w * 32 + linefind_ctz(lowest);
+			diff ^= lowest;
+		}
+	}
+	return count;
+}
+
+// Dark runs of the whole frame at least min_width wide, from the edge list. A run still open at
+// the end of the frame ends at LINECAM_PIXELS. A noisy frame can have more edges than fit, those
+// are listed LINEFIND_MAX_EDGES at a time; that's even, so every batch ends on white.
+uint8_t linefind_runs(const uint32_t *bits, uint8_t min_width, LineSegment_t *runs, uint8_t max) {
+	uint8_t edges[LINEFIND_MAX_EDGES];
+	uint8_t count = 0;
+	uint8_t from = 0;
+	uint8_t edge_count = LINEFIND_MAX_EDGES;
+
+	while (edge_count == LINEFIND_MAX_EDGES && count < max) {
+		edge_count = linefind_edges(bits, from, LINECAM_PIXELS, edges, LINEFIND_MAX_EDGES);
+		for (int i = 0; i < edge_count && count < max; i += 2) {
+			uint8_t end = (i + 1 < edge_count) ? edges[i + 1] : LINECAM_PIXELS;
+			if (end - edges[i] >= min_width) {
+				runs[count].start = edges[i];
+				runs[count].width = end - edges[i];
+				count++;
+			}
+		}
+		if (edge_count == LINEFIND_MAX_EDGES) {
+			from = edges[LINEFIND_MAX_EDGES - 1] + 1;
+		}
+	}
+	return count;
+}
+
+// First dark run inside [from, to) that has white on both sides. end is one past the last dark pixel.
+bool linefind_run(const uint32_t *bits, uint8_t from, uint8_t to, uint8_t *start, uint8_t *end) {
+	uint8_t edges[LINEFIND_MAX_EDGES];
+	// White on both sides means both edges sit strictly inside the window
+	uint8_t first = from + 1;
+	uint8_t edge_count = LINEFIND_MAX_EDGES;
+
+	while (edge_count == LINEFIND_MAX_EDGES) {
+		edge_count = linefind_edges(bits, first, to, edges, LINEFIND_MAX_EDGES);
+		for (int i = 0; i + 1 < edge_count; ++i) {
+			if (!LINECAM_BIT(bits, edges[i])) { // Dark after the edge, a run starts here
+				*start = edges[i];
+				*end = edges[i + 1];
+				return TRUE;
+			}
+		}
+		if (edge_count == LINEFIND_MAX_EDGES) {
+			first = edges[LINEFIND_MAX_EDGES - 1]; // The last run may close in the next batch
+		}
+	}
+	return FALSE;
+}
+
+// Lists every dark run of the packed frame and decides what kind of frame it is
+LineClass_t lineclass_classify(const uint32_t *bits, LineScene_t *scene) {
+	scene->count = linefind_runs(bits, LINEFIND_MIN_WIDTH, scene->segment, LINECLASS_MAX_SEGMENTS);
+
+	uint8_t tape = 0;
+	scene->type = LineClass_Ambiguous;
+	for (int i = 0; i < scene->count; ++i) {
+		if (scene->segment[i].width >= LINECLASS_CROSSING_WIDTH) {
+			scene->type = LineClass_Crossing;
+			return scene->type;
+		}
+		if (scene->segment[i].width <= LINEFIND_MAX_WIDTH) {
+			tape++;
+		}
+	}
+	if (scene->count == 0) {
+		scene->type = LineClass_Lost;
+	}
+	else if (scene->count == 1 && tape == 1) {
+		scene->type = LineClass_Line;
+	}
+	else if (scene->count == 3 && tape == 3) {
+		scene->type = LineClass_Finish;
+	}
+	return scene->type;
+}
+
+// Looks for the line within LINETRACK_WINDOW of the predicted center first, the whole frame after that.
+// Keeps the per-frame cost at about 2 * LINETRACK_WINDOW pixels while the line is tracked.
+bool linetrack_find(LineTrack_t *track, const uint32_t *bits, uint8_t *start, uint8_t *end) {
+	if (track->count > 0) {
+		// Constant velocity guess from the oldest and newest center in the history
+		uint8_t oldest = (track->head + LINETRACK_HISTORY - (track->count - 1)) % LINETRACK_HISTORY;
+		int32_t newest_q8 = track->history_q8[track->head];
+		int32_t predict_q8 = newest_q8;
+		if (track->count > 1) {
+			predict_q8 += (newest_q8 - track->history_q8[oldest]) / (track->count - 1);
+		}
+
+		int16_t predict = predict_q8 >> 8;
+		int16_t from = predict - LINETRACK_WINDOW;
+		int16_t to = predict + LINETRACK_WINDOW;
+		if (from < 0) from = 0;
+		if (to > LINECAM_PIXELS) to = LINECAM_PIXELS;
+		if (from < to && linefind_run(bits, from, to, start, end)) {
+			track->window_hits++;
+			return TRUE;
+		}
+	}
+
+	track->full_scans++;
+	return linefind_run(bits, 0, LINECAM_PIXELS, start, end);
+}
+
+void linetrack_update(LineTrack_t *track, uint16_t center_q8) {
+	track->head = (track->head + 1) % LINETRACK_HISTORY;
+	track->history_q8[track->head] = center_q8;
+	if (track->count < LINETRACK_HISTORY) {
+		track->count++;
+	}
+}
+
+// Forget the history, the next frame starts with a full scan
+void linetrack_lost(LineTrack_t *track) {
+	track->count = 0;
+}
+
+// Sub-pixel center of the dark run [start, end). Every pixel of the run plus one on each side
+// weighs in with how far it is below threshold, so partially covered edge pixels count partially.
+bool linefind_centroid(const uint16_t *frame, uint16_t threshold, uint8_t start, uint8_t end, LineFind_t *line) {
+	uint8_t from = start > 0 ? start - 1 : 0;
+	uint8_t to = end < LINECAM_PIXELS ? end + 1 : LINECAM_PIXELS;
+
+	uint32_t sum_w = 0;		// < 130 * 2^12
+	uint32_t sum_iw = 0;	// < 130 * 128 * 2^12
+	for (uint8_t i = from; i < to; ++i) {
+		if (frame[i] >= threshold) {
+			continue;
+		}
+		uint32_t w = (uint32_t)(threshold - frame[i]) >> WEIGHT_SHIFT;
+		sum_w += w;
+		sum_iw += i * w;
+	}
+
+	line->start = start;
+	line->width = end - start;
+	if (sum_w == 0) {
+		line->confidence = 0;
+		return FALSE;
+	}
+
+	// Quotient and remainder separately so the Q8 shift can't overflow. The weights sit on the
+	// pixel middles.
+	uint32_t whole = sum_iw / sum_w;
+	uint32_t frac = ((sum_iw % sum_w) << 8) / sum_w;
+	line->center_q8 = LINEFIND_MIDDLE_Q8(whole) + frac;
+
+	// Mean darkness of the run, 0..255, knocked down when the width doesn't look like tape
+	uint32_t depth = (sum_w / line->width) >> (12 - 8);
+	if (depth > 255) depth = 255;
+	if (line->width < LINEFIND_MIN_WIDTH || line->width > LINEFIND_MAX_WIDTH) {
+		depth >>= 2;
+	}
+	line->confidence = depth;
+	return TRUE;
+}
+
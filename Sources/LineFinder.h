@@ -0,0 +1,73 @@
+/*
+ * LineFinder.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_LINEFINDER_H_
+#define SOURCES_LINEFINDER_H_
+
+#include "PE_Types.h"
+#include "LineCamera.h"
+
+// Public defines
+// Line positions are Q8 pixels, pixel i covers [i, i+1). 64.0 is the middle of the frame.
+#define LINEFIND_Q8(px) ((int32_t)(px) << 8)	// Left edge of pixel px, or a pixel boundary.
+#define LINEFIND_MIDDLE_Q8(px) (LINEFIND_Q8(px) + 128)	// Middle of pixel px.
+#define LINEFIND_MIN_WIDTH 2					// Runs narrower than this are noise.
+#define LINEFIND_MAX_WIDTH 24					// Runs wider than this are not the tape.
+#define LINETRACK_HISTORY 4						// Frames the prediction is based on.
+#define LINETRACK_WINDOW 16						// Pixels searched either side of the prediction.
+#define LINEFIND_MAX_EDGES 64					// Edges listed per batch, even. Bounds the stack, not the frame.
+#define LINECLASS_MAX_SEGMENTS 8				// Dark runs kept per frame, more than this is noise anyway.
+#define LINECLASS_CROSSING_WIDTH 48				// A dark run this wide is tape across our path.
+
+// Public typedefs
+typedef struct LineFind_t {
+	uint16_t center_q8;		// Intensity weighted line center, pixels in Q8.
+	uint8_t start;			// First dark pixel of the run.
+	uint8_t width;			// Dark pixels in the run.
+	uint8_t confidence;		// 0 = no line, 255 = deep, sharp, plausibly sized line.
+} LineFind_t;
+
+// What the camera is looking at
+typedef enum LineClass_t {
+	LineClass_Lost,			// No dark run at all.
+	LineClass_Line,			// Exactly one tape sized run.
+	LineClass_Crossing,		// A run too wide to be the line, the other track crosses ours.
+	LineClass_Finish,		// Three tape sized runs, the start/finish marks either side of the line.
+	LineClass_Ambiguous,	// Anything else, let the tracker sort it out.
+} LineClass_t;
+
+typedef struct LineSegment_t {
+	uint8_t start;
+	uint8_t width;
+} LineSegment_t;
+
+typedef struct LineScene_t {
+	LineClass_t type;
+	uint8_t count;			// Entries used in segment, left to right.
+	LineSegment_t segment[LINECLASS_MAX_SEGMENTS];
+} LineScene_t;
+
+// Region of interest tracker, searches around where the last frames say the line should be
+typedef struct LineTrack_t {
+	uint16_t history_q8[LINETRACK_HISTORY];	// Recent centers, newest at [head].
+	uint8_t head;
+	uint8_t count;			// Valid history entries.
+	uint32_t window_hits;	// Frames found inside the window.
+	uint32_t full_scans;	// Frames that needed the whole line.
+} LineTrack_t;
+
+// Public functions
+uint8_t linefind_edges(const uint32_t *bits, uint8_t from, uint8_t to, uint8_t *edges, uint8_t max);
+uint8_t linefind_runs(const uint32_t *bits, uint8_t min_width, LineSegment_t *runs, uint8_t max);
+bool linefind_run(const uint32_t *bits, uint8_t from, uint8_t to, uint8_t *start, uint8_t *end);
+bool linefind_centroid(const uint16_t *frame, uint16_t threshold, uint8_t start, uint8_t end, LineFind_t *line);
+LineClass_t lineclass_classify(const uint32_t *bits, LineScene_t *scene);
+bool linetrack_find(LineTrack_t *track, const uint32_t *bits, uint8_t *start, uint8_t *end);
+void linetrack_update(LineTrack_t *track, uint16_t center_q8);
+void linetrack_lost(LineTrack_t *track);
+
+#endif /* SOURCES_LINEFINDER_H_ */
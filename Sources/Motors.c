@@ -5,73 +5,402 @@
  *      Author: JPM
  */
 
+#include "Cpu.h"
 #include "Motors.h"
+#include "Timebase.h"
+#include "Vectors.h"
+
+// Private defines
+#define MIN_DUTY 0xFFFF
+#define MOTORS_HALF_TRACK Q16(MOTORS_TRACK_IN / 2)
+// Channel value registers behind the PWM components
+#define MOTORS_FB_CnV TPM0_C0V
+#define MOTORS_BB_CnV TPM0_C1V
+#define MOTORS_FA_CnV TPM0_C2V
+#define MOTORS_BA_CnV TPM0_C3V
+// Pins of a side that carry the duty
+#define PINS_F 0x1
+#define PINS_B 0x2
+
+// Private typedefs
+// PWM_xx ratios, same meaning as PWM_xx_SetRatio16
+typedef struct MotorRatios_t {
+	uint16_t fa;
+	uint16_t ba;
+	uint16_t fb;
+	uint16_t bb;
+} MotorRatios_t;
+
+// TPM0 channel values, ratios scaled to the period
+typedef struct MotorCnV_t {
+	uint16_t fa;
+	uint16_t ba;
+	uint16_t fb;
+	uint16_t bb;
+} MotorCnV_t;
 
 // Private variables
 MotorDir_t CurrentDirection = MotorDir_Forward;
 uint16_t CurrentSpeed = 0;
-#define MIN_DUTY 0xFFFF
+uint16_t CurrentLeft = 0;
+uint16_t CurrentRight = 0;
+static uint8_t pins_a = PINS_F;			// PINS_* each side is driven on right now
+static uint8_t pins_b = PINS_F;
+static bool live_a = FALSE;				// The side is being driven, not just held off
+static bool live_b = FALSE;
+static MotorCnV_t cnv_deferred;			// Too close to a wrap to write, motors_tpm0_isr writes it
+static volatile bool cnv_is_deferred = FALSE;
+#if MOTORS_SHAPE
+static MotorLimits_t limits;			// Zeros until motors_set_limits, no limits
+static MotorDir_t target_dir = MotorDir_Forward;	// Last command from the control code
+static uint16_t target_left = 0;
+static uint16_t target_right = 0;
+static MotorDir_t shape_dir = MotorDir_Forward;	// What the shaper is putting out
+static uint16_t shape_left = 0;
+static uint16_t shape_right = 0;
+static uint32_t rate_left = 0;			// Current rise rate, counts per ms
+static uint32_t rate_right = 0;
+static uint32_t shape_time_us = 0;
+static bool braking = FALSE;			// In the brake phase of a reversal
+static uint32_t brake_since_us;
+#endif
+#if MOTORS_DEAD_TIME
+static MotorRatios_t pending;			// Command waiting out the dead time
+static uint8_t pending_pins_a;
+static uint8_t pending_pins_b;
+static bool held_a = FALSE;				// Side is off until motors_poll applies pending
+static bool held_b = FALSE;
+static uint32_t held_since_us;
+#endif
+
+// Private function declarations
+static void motors_output(MotorDir_t dir, uint16_t left, uint16_t right);
+#if MOTORS_SHAPE
+static void motors_shape_step(void);
+static uint16_t motors_shape_side(uint16_t current, uint16_t target, uint32_t *rate, uint32_t dt_us, bool brake);
+#endif
+#if MOTORS_DEAD_TIME
+static void motors_dead_time_poll(void);
+#endif
+static void motors_side_a(MotorRatios_t *ratios, uint8_t pins, uint16_t speed);
+static void motors_side_b(MotorRatios_t *ratios, uint8_t pins, uint16_t speed);
+static void motors_write(const MotorRatios_t *ratios);
+static void motors_write_cnv(const MotorCnV_t *cnv);
 
 // Public function definitions
+void motors_init(void) {
+	// The overflow interrupt picks up writes deferred by motors_write, nothing else uses it
+	vectors_set(INT_TPM0, motors_tpm0_isr);
+	TPM0_SC |= TPM_SC_TOF_MASK; // Write 1 to clear
+	TPM0_SC |= TPM_SC_TOIE_MASK;
+	NVIC_ICPR = 1u << (INT_TPM0 - 16);
+	NVIC_ISER = 1u << (INT_TPM0 - 16);
+}
+
 void motors_set(MotorDir_t dir, uint16_t speed) {
+	motors_set_sides(dir, speed, speed);
+}
+
+// Same direction on both sides, each side with its own duty. With MOTORS_SHAPE this is
+// the target, motors_poll ramps the bridge to it.
+void motors_set_sides(MotorDir_t dir, uint16_t left, uint16_t right) {
+#if MOTORS_SHAPE
+	target_dir = dir;
+	target_left = left;
+	target_right = right;
+#else
+	motors_output(dir, left, right);
+#endif
+}
+
+#if MOTORS_SHAPE
+void motors_set_limits(const MotorLimits_t *new_limits) {
+	limits = *new_limits;
+}
+#endif
+
+// Call from the main loop
+void motors_poll(void) {
+#if MOTORS_SHAPE
+	motors_shape_step();
+#endif
+#if MOTORS_DEAD_TIME
+	motors_dead_time_poll();
+#endif
+}
+
+// Electronic differential. Each rear wheel runs at the speed of its own arc,
+// v * (1 -+ curvature * track / 2), positive curvature turns left. gain scales the split
+// and it fades in from standstill so the car doesn't pivot off the line.
+void motors_set_differential(MotorDir_t dir, uint16_t speed, Q16_t curvature, Q16_t velocity, Q16_t gain) {
+	if (dir != MotorDir_Forward) {
+		motors_set(dir, speed); // No split backing up or braking, both sides get the same duty
+		return;
+	}
+	Q16_t split = q16_mul(q16_mul(curvature, MOTORS_HALF_TRACK), gain);
+	if (velocity < Q16_FROM_INT(MOTORS_DIFF_FULL_SPEED)) {
+		split = q16_mul(split, q16_div(velocity < 0 ? 0 : velocity, Q16_FROM_INT(MOTORS_DIFF_FULL_SPEED)));
+	}
+	split = (split > Q16_ONE) ? Q16_ONE : (split < -Q16_ONE) ? -Q16_ONE : split;
+
+	int32_t delta = q16_mul(split, speed); // Q16 times an integer is an integer
+	int32_t left = (int32_t)speed - delta;
+	int32_t right = (int32_t)speed + delta;
+	left = (left < 0) ? 0 : (left > 0xFFFF) ? 0xFFFF : left;
+	right = (right < 0) ? 0 : (right > 0xFFFF) ? 0xFFFF : right;
+	motors_set_sides(dir, left, right);
+}
+
+uint16_t motors_get_duty(void) {
+	return CurrentSpeed;
+}
+
+uint16_t motors_get_left(void) {
+	return CurrentLeft;
+}
+
+uint16_t motors_get_right(void) {
+	return CurrentRight;
+}
+
+//uint16_t motors_get_speed(void) {
+//	return CurrentSpeed;
+//}
+//
+//MotorDir_t motors_get_dir(void) {
+//	return CurrentDirection;
+//}
+
+// TPM0 wrapped, a deferred write now has the whole period before the next one
+PE_ISR(motors_tpm0_isr)
+{
+	TPM0_SC |= TPM_SC_TOF_MASK;
+	if (cnv_is_deferred) {
+		motors_write_cnv(&cnv_deferred);
+		cnv_is_deferred = FALSE;
+	}
+}
+
+
+// Private function definitions
+// Puts a command on the bridge
+static void motors_output(MotorDir_t dir, uint16_t left, uint16_t right) {
 	CurrentDirection = dir;
-	CurrentSpeed = speed;
-//	PWM_BA_SetRatio16(MIN_DUTY);
-//	PWM_BB_SetRatio16(MIN_DUTY);
-//	PWM_FA_SetRatio16(MIN_DUTY);
-//	PWM_FB_SetRatio16(MIN_DUTY);
+	CurrentSpeed = ((uint32_t)left + right) / 2;
+	CurrentLeft = left;
+	CurrentRight = right;
+#if MOTORS_LEFT_IS_A
+	uint16_t speed_a = left;
+	uint16_t speed_b = right;
+#else
+	uint16_t speed_a = right;
+	uint16_t speed_b = left;
+#endif
 
+	uint8_t p_a;
+	uint8_t p_b;
 	switch (dir) {
 	case MotorDir_Forward:
-		PWM_BA_SetRatio16(MIN_DUTY);
-		PWM_BB_SetRatio16(MIN_DUTY);
-		PWM_FA_SetRatio16(MIN_DUTY - speed);
-		PWM_FB_SetRatio16(MIN_DUTY - speed);
+		p_a = PINS_F;
+		p_b = PINS_F;
 		break;
 
 	case MotorDir_Backward:
-		PWM_FA_SetRatio16(MIN_DUTY);
-		PWM_FB_SetRatio16(MIN_DUTY);
-		PWM_BA_SetRatio16(MIN_DUTY - speed);
-		PWM_BB_SetRatio16(MIN_DUTY - speed);
+		p_a = PINS_B;
+		p_b = PINS_B;
 		break;
 
 	case MotorDir_BrakeTop:
-		PWM_BA_SetRatio16(MIN_DUTY);
-		PWM_FB_SetRatio16(MIN_DUTY);
-		PWM_FA_SetRatio16(MIN_DUTY - speed);
-		PWM_BB_SetRatio16(MIN_DUTY - speed);
+		p_a = PINS_F;
+		p_b = PINS_B;
 		break;
 
-	case MotorDir_BrakeBottom:
-		PWM_FA_SetRatio16(MIN_DUTY);
-		PWM_BB_SetRatio16(MIN_DUTY);
-		PWM_BA_SetRatio16(MIN_DUTY - speed);
-		PWM_FB_SetRatio16(MIN_DUTY - speed);
+	case MotorDir_Brake:
+		p_a = PINS_F | PINS_B;
+		p_b = PINS_F | PINS_B;
 		break;
 
+	case MotorDir_Coast:
+		p_a = 0;
+		p_b = 0;
+		break;
+
+	case MotorDir_BrakeBottom:
 	default: // Panic
-		PWM_FA_SetRatio16(MIN_DUTY);
-		PWM_BB_SetRatio16(MIN_DUTY);
-		PWM_BA_SetRatio16(MIN_DUTY - speed);
-		PWM_FB_SetRatio16(MIN_DUTY - speed);
+		p_a = PINS_B;
+		p_b = PINS_F;
 		break;
 	}
+
+	MotorRatios_t ratios;
+	motors_side_a(&ratios, p_a, speed_a);
+	motors_side_b(&ratios, p_b, speed_b);
+#if MOTORS_DEAD_TIME
+	// A side that changes its driven pins goes fully off first, motors_poll finishes the change
+	bool reverse_a = live_a && p_a != pins_a;
+	bool reverse_b = live_b && p_b != pins_b;
+	if (reverse_a || reverse_b) {
+		held_since_us = timebase_us();
+	}
+	held_a = held_a || reverse_a;
+	held_b = held_b || reverse_b;
+	if (held_a || held_b) {
+		pending = ratios;
+		pending_pins_a = p_a;
+		pending_pins_b = p_b;
+		if (held_a) {
+			motors_side_a(&ratios, pins_a, 0);
+			p_a = pins_a;
+			speed_a = 0;
+		}
+		if (held_b) {
+			motors_side_b(&ratios, pins_b, 0);
+			p_b = pins_b;
+			speed_b = 0;
+		}
+	}
+#endif
+	pins_a = p_a;
+	pins_b = p_b;
+	live_a = p_a != 0 && speed_a != 0;
+	live_b = p_b != 0 && speed_b != 0;
+	motors_write(&ratios);
 }
 
-uint16_t motors_get_duty(void) {
-	return CurrentSpeed;
+#if MOTORS_SHAPE
+// One shaper step per PWM period, CnV only loads once a period anyway. A change of direction
+// first brings both sides down to 0, and Forward <-> Backward brakes for MOTORS_BRAKE_PHASE_US
+// in between instead of driving the motors against their own back EMF.
+static void motors_shape_step(void) {
+	uint32_t now_us = timebase_us();
+	uint32_t dt_us = now_us - shape_time_us;
+	if (dt_us < MOTORS_PERIOD_US) {
+		return;
+	}
+	shape_time_us = now_us;
+	if (dt_us > 2 * MOTORS_PERIOD_US) {
+		dt_us = MOTORS_PERIOD_US; // First step or a stall, don't jump
+	}
+
+	MotorDir_t dir = target_dir;
+	uint16_t left = target_left;
+	uint16_t right = target_right;
+	if (braking && now_us - brake_since_us < MOTORS_BRAKE_PHASE_US) {
+		dir = MOTORS_REVERSAL_BRAKE;
+		left = limits.brake;
+		right = limits.brake;
+	}
+	else {
+		braking = FALSE;
+	}
+
+	if (dir != shape_dir) {
+		if (shape_left == 0 && shape_right == 0) {
+			if ((shape_dir == MotorDir_Forward && dir == MotorDir_Backward) || (shape_dir == MotorDir_Backward && dir == MotorDir_Forward)) {
+				braking = TRUE;
+				brake_since_us = now_us;
+				dir = MOTORS_REVERSAL_BRAKE;
+				left = limits.brake;
+				right = limits.brake;
+			}
+			shape_dir = dir;
+			rate_left = 0;
+			rate_right = 0;
+		}
+		else {
+			left = 0;
+			right = 0;
+		}
+	}
+	bool brake = shape_dir == MotorDir_BrakeTop || shape_dir == MotorDir_BrakeBottom || shape_dir == MotorDir_Brake;
+	shape_left = motors_shape_side(shape_left, left, &rate_left, dt_us, brake);
+	shape_right = motors_shape_side(shape_right, right, &rate_right, dt_us, brake);
+	motors_output(shape_dir, shape_left, shape_right);
 }
 
-//uint16_t motors_get_speed(void) {
-//	return CurrentSpeed;
-//}
-//
-//MotorDir_t motors_get_dir(void) {
-//	return CurrentDirection;
-//}
+// Moves one side's duty towards target. Falling is limited by fall, rising by a rate that
+// grows by jerk up to rise, or straight at brake_rise for a brake. A limit of 0 doesn't limit.
+static uint16_t motors_shape_side(uint16_t current, uint16_t target, uint32_t *rate, uint32_t dt_us, bool brake) {
+	if (target <= current) {
+		*rate = 0;
+		uint32_t step = limits.fall ? (uint32_t)limits.fall * dt_us / 1000 : 0xFFFF;
+		return ((uint32_t)(current - target) > step) ? current - step : target;
+	}
+	uint16_t rise = brake ? limits.brake_rise : limits.rise;
+	uint16_t jerk = brake ? 0 : limits.jerk;
+	if (rise == 0) {
+		*rate = 0;
+		return target;
+	}
+	*rate = jerk ? *rate + (uint32_t)jerk * dt_us / 1000 : rise;
+	if (*rate > rise) {
+		*rate = rise;
+	}
+	uint32_t step = *rate * dt_us / 1000;
+	if ((uint32_t)(target - current) > step) {
+		return current + step;
+	}
+	*rate = 0;
+	return target;
+}
+#endif
+
+#if MOTORS_DEAD_TIME
+// Applies a reversal held back by motors_output once the off state has been out for a full
+// PWM period plus the dead time
+static void motors_dead_time_poll(void) {
+	if (!(held_a || held_b) || timebase_us() - held_since_us < MOTORS_PERIOD_US + MOTORS_DEAD_TIME_US) {
+		return;
+	}
+	held_a = FALSE;
+	held_b = FALSE;
+	pins_a = pending_pins_a;
+	pins_b = pending_pins_b;
+	live_a = pending.fa != MIN_DUTY || pending.ba != MIN_DUTY;
+	live_b = pending.fb != MIN_DUTY || pending.bb != MIN_DUTY;
+	motors_write(&pending);
+}
+#endif
 
+// Drives the PINS_* of the side with speed and holds the others off
+static void motors_side_a(MotorRatios_t *ratios, uint8_t pins, uint16_t speed) {
+	ratios->fa = (pins & PINS_F) ? MIN_DUTY - speed : MIN_DUTY;
+	ratios->ba = (pins & PINS_B) ? MIN_DUTY - speed : MIN_DUTY;
+}
 
-// Private function definitions
+static void motors_side_b(MotorRatios_t *ratios, uint8_t pins, uint16_t speed) {
+	ratios->fb = (pins & PINS_F) ? MIN_DUTY - speed : MIN_DUTY;
+	ratios->bb = (pins & PINS_B) ? MIN_DUTY - speed : MIN_DUTY;
+}
 
+// Writes all four channels to TPM0. CnV only loads when the counter wraps, so as long as no wrap
+// falls between the writes the whole bridge changes on the same PWM period. Too close to a wrap
+// the write is left to motors_tpm0_isr instead of waiting for it with interrupts masked.
+static void motors_write(const MotorRatios_t *ratios) {
+	uint32_t period = (uint32_t)TPM0_MOD + 1;
+	MotorCnV_t cnv = {
+		.fa = ((uint32_t)ratios->fa * period) >> 16, // Same scaling as PWM_xx_SetRatio16
+		.ba = ((uint32_t)ratios->ba * period) >> 16,
+		.fb = ((uint32_t)ratios->fb * period) >> 16,
+		.bb = ((uint32_t)ratios->bb * period) >> 16,
+	};
+	uint32_t guard = (period >> 10) + 2; // About 20us, plenty for four stores
 
+	EnterCritical();
+	if (TPM0_CNT + guard >= period) {
+		cnv_deferred = cnv;
+		cnv_is_deferred = TRUE;
+	}
+	else {
+		motors_write_cnv(&cnv);
+		cnv_is_deferred = FALSE; // Newer than anything still waiting
+	}
+	ExitCritical();
+}
+
+static void motors_write_cnv(const MotorCnV_t *cnv) {
+	MOTORS_FA_CnV = cnv->fa;
+	MOTORS_BA_CnV = cnv->ba;
+	MOTORS_FB_CnV = cnv->fb;
+	MOTORS_BB_CnV = cnv->bb;
+}
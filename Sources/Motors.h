@@ -10,19 +10,57 @@
 
 #include "PE_Types.h"
 #include "Events.h"
+#include "Fixed.h"
+
+// Config switches
+#define MOTORS_LEFT_IS_A 1 // 1: PWM_FA/PWM_BA drive the left wheel, 0: the right one
+#define MOTORS_DEAD_TIME 1 // 1: a side reversing its drive pin is held off for a period plus MOTORS_DEAD_TIME_US first
+#define MOTORS_SHAPE 1 // 1: motors_set* only set a target, motors_poll ramps to it within the MotorLimits_t limits
+// NOTE: motors_init installs motors_tpm0_isr for INT_TPM0, vectors_init has to run first.
+
+// Public defines
+#define MOTORS_PERIOD_US 20000			// TPM0 period configured in Processor Expert, shared with the Servo.
+#define MOTORS_DEAD_TIME_US 500			// Both pins of a side off between driving one and the other.
+#define MOTORS_BRAKE_PHASE_US 60000		// Brake time between Forward and Backward.
+#define MOTORS_REVERSAL_BRAKE MotorDir_Brake
+#define MOTORS_TRACK_IN 5.5				// Rear wheel spacing, center to center.
+#define MOTORS_DIFF_FULL_SPEED 12		// Inches per second where the differential is fully in, it fades in from standstill.
 
 // Public typedefs
+// Wiring assumed: each wheel has its own H-bridge, PWM_Fx drives one half towards the supply
+// and PWM_Bx the other half, an undriven half sits on ground. BrakeTop and BrakeBottom drive
+// the two wheels opposite ways under that wiring; Brake and Coast treat both wheels alike.
 typedef enum MotorDir_t {
-	MotorDir_Forward,
-	MotorDir_Backward,
-	MotorDir_BrakeTop,
-	MotorDir_BrakeBottom,
+	MotorDir_Forward,		// F pins carry the duty
+	MotorDir_Backward,		// B pins carry the duty
+	MotorDir_BrakeTop,		// FA and BB carry the duty
+	MotorDir_BrakeBottom,	// BA and FB carry the duty
+	MotorDir_Brake,			// F and B pins carry the duty together, brake strength follows it
+	MotorDir_Coast,			// All pins off whatever the duty, a brake through ground on drivers that don't float their outputs
 } MotorDir_t;
 
+typedef struct MotorLimits_t {
+	uint16_t rise;			// Duty counts per ms a side may speed up by, 0 = unlimited
+	uint16_t fall;			// Duty counts per ms a side may slow down by, 0 = unlimited
+	uint16_t jerk;			// Duty counts per ms^2 the rise rate may grow by, 0 = unlimited
+	uint16_t brake_rise;	// Duty counts per ms a brake may come in by, no jerk limit, 0 = unlimited
+	uint16_t brake;			// Duty in the brake phase of a reversal
+} MotorLimits_t;
+
 // Public functions
+void motors_init(void);
 void motors_set(MotorDir_t direction, uint16_t duty);
+void motors_set_sides(MotorDir_t direction, uint16_t left, uint16_t right);
+void motors_set_differential(MotorDir_t direction, uint16_t duty, Q16_t curvature, Q16_t velocity, Q16_t gain);
+#if MOTORS_SHAPE
+void motors_set_limits(const MotorLimits_t *limits);
+#endif
+void motors_poll(void);
 uint16_t motors_get_duty(void);
+uint16_t motors_get_left(void);
+uint16_t motors_get_right(void);
 //uint16_t motors_get_speed(void);
 //MotorDir_t motors_get_dir(void);
+PE_ISR(motors_tpm0_isr);
 
 #endif /* SOURCES_MOTORS_H_ */
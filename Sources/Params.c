@@ -0,0 +1,144 @@
+/*
+ * Params.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include <stddef.h>
+#include "Cpu.h"
+#include "Params.h"
+
+#define PARAM(field, type, min, max, fallback) { offsetof(Params_t, field), type, min, max, fallback }
+
+// Public variables
+Params_t params;
+
+// Private variables
+// Units next to each entry, Kds and Kpv defaults differ from the old constants for the reason given.
+// Param_Reserved3 has no entry, params_exists keeps it out.
+static const ParamInfo_t info[Param_Count] = {
+	[Param_Kps]			= PARAM(Kps, ParamType_Q16, 0, 200, 30),					// Servo us per pixel of error
+	[Param_Kds]			= PARAM(Kds, ParamType_Q16, 0, 0.5f, 0.0125f),			// Servo us per pixel per second, was 2.5 per pixel per frame at 200 frames/s
+	[Param_Kpv]			= PARAM(Kpv, ParamType_Q16, 0, 10000, 500),				// Duty counts (of 0xFFFF) per inch per second, the baseline's 1 barely moved the duty
+	[Param_Bv]			= PARAM(Bv, ParamType_Q16, 0, 0.99f, 0.1f),				// Weight of the previous velocity sample
+	[Param_Bs]			= PARAM(Bs, ParamType_Q16, 0, 0.99f, 0.1f),				// Weight of the previous steering derivative
+	[Param_VelocityMax]	= PARAM(velocity_max, ParamType_Q16, 0, 120, 36),			// Inches per second
+	[Param_ServoCenter]	= PARAM(Servo_Center, ParamType_U16, 20000 - 1100, 20000 - 400, 20000 - 750),	// Servo_SetDutyUS us
+	[Param_ServoLeft]	= PARAM(Servo_Left, ParamType_U16, 20000 - 1100, 20000 - 400, 20000 - 450),		// Servo_SetDutyUS us
+	[Param_ServoRight]	= PARAM(Servo_Right, ParamType_U16, 20000 - 1100, 20000 - 400, 20000 - 1050),	// Servo_SetDutyUS us
+	[Param_Kis]			= PARAM(Kis, ParamType_Q16, 0, 200, 0),					// Servo us per pixel second
+	[Param_ServoSlew]	= PARAM(Servo_Slew, ParamType_U16, 0, 60000, 30000),		// Servo us per second, 0 = unlimited
+	[Param_Kiv]			= PARAM(Kiv, ParamType_Q16, 0, 30000, 2000),				// Duty counts per inch
+	[Param_DutyMax]		= PARAM(Duty_Max, ParamType_U16, 0, 0xFFFF, 0xC000),		// Duty counts, 0xFFFF = full
+	[Param_BrakeMax]	= PARAM(Brake_Max, ParamType_U16, 0, 0xFFFF, 0x8000),		// Duty counts, 0xFFFF = full
+	[Param_LateralAccel]	= PARAM(Lateral_Accel, ParamType_Q16, 0, 1000, 150),	// Inches per second^2
+	[Param_Decel]		= PARAM(Decel, ParamType_Q16, 0, 1000, 120),				// Inches per second^2
+	[Param_Accel]		= PARAM(Accel, ParamType_Q16, 0, 1000, 80),				// Inches per second^2
+	[Param_KpsSchedule0]	= PARAM(steer_schedule.kp[0], ParamType_Q16, 0, 4, 1.25f),	// Multiplier on Kps
+	[Param_KpsSchedule1]	= PARAM(steer_schedule.kp[1], ParamType_Q16, 0, 4, 1),
+	[Param_KpsSchedule2]	= PARAM(steer_schedule.kp[2], ParamType_Q16, 0, 4, 0.8f),
+	[Param_KpsSchedule3]	= PARAM(steer_schedule.kp[3], ParamType_Q16, 0, 4, 0.65f),
+	[Param_KpsSchedule4]	= PARAM(steer_schedule.kp[4], ParamType_Q16, 0, 4, 0.55f),
+	[Param_KdsSchedule0]	= PARAM(steer_schedule.kd[0], ParamType_Q16, 0, 4, 1),	// Multiplier on Kds
+	[Param_KdsSchedule1]	= PARAM(steer_schedule.kd[1], ParamType_Q16, 0, 4, 1),
+	[Param_KdsSchedule2]	= PARAM(steer_schedule.kd[2], ParamType_Q16, 0, 4, 1),
+	[Param_KdsSchedule3]	= PARAM(steer_schedule.kd[3], ParamType_Q16, 0, 4, 1),
+	[Param_KdsSchedule4]	= PARAM(steer_schedule.kd[4], ParamType_Q16, 0, 4, 1),
+	[Param_DiffGain]	= PARAM(Diff_Gain, ParamType_Q16, 0, 2, 1),				// 1 = wheels follow their own arcs, 0 = off
+	[Param_MotorRise]	= PARAM(Motor_Rise, ParamType_U16, 0, 0xFFFF, 400),		// Duty counts per ms, 0 = unlimited
+	[Param_MotorFall]	= PARAM(Motor_Fall, ParamType_U16, 0, 0xFFFF, 2000),		// Duty counts per ms, 0 = unlimited
+	[Param_MotorJerk]	= PARAM(Motor_Jerk, ParamType_U16, 0, 0xFFFF, 10),		// Duty counts per ms^2, 0 = unlimited
+	[Param_BrakeRise]	= PARAM(Brake_Rise, ParamType_U16, 0, 0xFFFF, 0),		// Duty counts per ms, 0 = unlimited
+};
+
+static Params_t staged;					// params plus every set since the last params_apply
+static volatile bool staged_dirty = FALSE;
+
+// Private function declarations
+static bool params_exists(ParamId_t id);
+static float params_read(const Params_t *from, ParamId_t id);
+static void params_write(Params_t *to, ParamId_t id, float value);
+
+// Public function definitions
+// Loads every parameter's power-up default
+void params_init(void) {
+	for (int id = 0; id < Param_Count; ++id) {
+		if (params_exists(id)) {
+			params_write(&params, id, info[id].fallback);
+		}
+	}
+	staged_dirty = FALSE;
+}
+
+// NULL for an id that isn't a parameter
+const ParamInfo_t *params_info(ParamId_t id) {
+	return params_exists(id) ? &info[id] : NULL;
+}
+
+// The value the controller will use from the next params_apply on
+float params_get(ParamId_t id) {
+	return params_read(staged_dirty ? &staged : &params, id);
+}
+
+// Stages a new value, the controller only sees it after the next params_apply
+TelemAckStatus_t params_set(ParamId_t id, float value) {
+	if (!params_exists(id)) {
+		return TelemAck_BadParam;
+	}
+	const ParamInfo_t *p = &info[id];
+	if (!(value >= p->min && value <= p->max)) { // Also rejects NaN
+		return TelemAck_OutOfRange;
+	}
+
+	EnterCritical();
+	if (!staged_dirty) {
+		staged = params;
+	}
+	params_write(&staged, id, value);
+	staged_dirty = TRUE;
+	ExitCritical();
+	return TelemAck_Ok;
+}
+
+// Call between control cycles, every staged value takes effect at once
+void params_apply(void) {
+	if (!staged_dirty) {
+		return;
+	}
+	EnterCritical(); // Cap1_OnCapture reads params too
+	params = staged;
+	staged_dirty = FALSE;
+	ExitCritical();
+}
+
+// Private function definitions
+static bool params_exists(ParamId_t id) {
+	return id < Param_Count && id != Param_Reserved3;
+}
+
+static float params_read(const Params_t *from, ParamId_t id) {
+	if (!params_exists(id)) {
+		return 0;
+	}
+	const uint8_t *field = (const uint8_t *)from + info[id].offset;
+	switch (info[id].type) {
+	case ParamType_Q16:
+		return q16_to_float(*(const Q16_t *)field);
+	case ParamType_U16:
+		return *(const uint16_t *)field;
+	}
+	return 0;
+}
+
+static void params_write(Params_t *to, ParamId_t id, float value) {
+	uint8_t *field = (uint8_t *)to + info[id].offset;
+	switch (info[id].type) {
+	case ParamType_Q16:
+		*(Q16_t *)field = q16_from_float(value);
+		break;
+	case ParamType_U16:
+		*(uint16_t *)field = (uint16_t)(value + 0.5f);
+		break;
+	}
+}
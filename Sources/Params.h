@@ -0,0 +1,62 @@
+/*
+ * Params.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_PARAMS_H_
+#define SOURCES_PARAMS_H_
+
+#include "PE_Types.h"
+#include "TelemetryFormat.h"
+#include "Fixed.h"
+#include "Steering.h"
+
+// Public typedefs
+// Values the controller runs with, only params_apply writes them
+typedef struct Params_t {
+	Q16_t Kps;
+	Q16_t Kds;
+	Q16_t Kpv;
+	Q16_t Bv;
+	Q16_t Bs;
+	Q16_t velocity_max;		// Inches per second.
+	uint16_t Servo_Center;
+	uint16_t Servo_Left;
+	uint16_t Servo_Right;
+	Q16_t Kis;
+	uint16_t Servo_Slew;	// us per second.
+	Q16_t Kiv;
+	uint16_t Duty_Max;
+	uint16_t Brake_Max;
+	Q16_t Lateral_Accel;	// Inches per second^2.
+	Q16_t Decel;
+	Q16_t Accel;
+	SteeringSchedule_t steer_schedule;	// Scales Kps and Kds by speed.
+	Q16_t Diff_Gain;
+	uint16_t Motor_Rise;	// Duty per ms.
+	uint16_t Motor_Fall;
+	uint16_t Motor_Jerk;	// Duty per ms^2.
+	uint16_t Brake_Rise;	// Duty per ms.
+} Params_t;
+
+typedef struct ParamInfo_t {
+	uint16_t offset;		// Of the value in Params_t.
+	ParamType_t type;
+	float min;
+	float max;
+	float fallback;			// Power-up default.
+} ParamInfo_t;
+
+// Public variables
+extern Params_t params;
+
+// Public functions
+void params_init(void);
+const ParamInfo_t *params_info(ParamId_t id);
+float params_get(ParamId_t id);
+TelemAckStatus_t params_set(ParamId_t id, float value);
+void params_apply(void);
+
+#endif /* SOURCES_PARAMS_H_ */
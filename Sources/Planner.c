@@ -0,0 +1,92 @@
+/*
+ * Planner.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "Planner.h"
+
+// Private defines
+#define PLANNER_CURVATURE_LOCK Q16(1.0 / PLANNER_TURN_RADIUS_IN)
+#define PLANNER_INCHES_PER_PIXEL Q16(PLANNER_VIEW_WIDTH_IN / 128)
+// Arc through the car and a point offset x at distance L ahead has curvature 2x / L^2
+#define PLANNER_OFFSET_TO_CURVATURE Q16(2.0 / (PLANNER_LOOKAHEAD_IN * PLANNER_LOOKAHEAD_IN))
+
+// Private function declarations
+static Q16_t planner_corner_speed(Q16_t lateral_accel, Q16_t curvature);
+static Q16_t planner_abs(Q16_t value);
+
+// Public function definitions
+void planner_reset(Planner_t *planner) {
+	for (int i = 0; i < PLANNER_HISTORY; ++i) {
+		planner->offset[i] = 0;
+	}
+	planner->offset_sum = 0;
+	planner->next = 0;
+	planner->curvature_now = 0;
+	planner->curvature_ahead = 0;
+	planner->target = 0;
+	planner->time_prev_us = 0;
+	planner->primed = FALSE;
+}
+
+// Speed target from the curvature under the car (servo) and the curvature the camera sees ahead
+// (line offset). The corner ahead caps speed at what the brakes can shed over the look-ahead,
+// v^2 = v_corner^2 + 2 * decel * L, so slowing starts before the car is in the turn.
+// offset_q8 is line center - image center in pixels Q8.
+Q16_t planner_update(Planner_t *planner, const PlannerGains_t *gains, int32_t offset_q8, uint16_t servo, uint32_t now_us) {
+	// Curvature ahead, averaged over the last few frames
+	Q16_t offset = q16_mul(planner_abs(offset_q8 << 8), PLANNER_INCHES_PER_PIXEL);
+	planner->offset_sum += offset - planner->offset[planner->next];
+	planner->offset[planner->next] = offset;
+	planner->next = (planner->next + 1) & (PLANNER_HISTORY - 1);
+	planner->curvature_ahead = q16_mul(planner->offset_sum / PLANNER_HISTORY, PLANNER_OFFSET_TO_CURVATURE);
+
+	// Curvature now, the servo swing as a fraction of full lock, positive turning left
+	int32_t swing = (int32_t)servo - gains->servo_center;
+	int32_t lock = (int32_t)gains->servo_left - gains->servo_center;
+	Q16_t fraction = q16_div(swing, lock);
+	fraction = (fraction > Q16_ONE) ? Q16_ONE : (fraction < -Q16_ONE) ? -Q16_ONE : fraction;
+	planner->curvature_now = q16_mul(fraction, PLANNER_CURVATURE_LOCK);
+
+	Q16_t target = gains->velocity_max;
+	Q16_t now = planner_corner_speed(gains->lateral_accel, planner_abs(planner->curvature_now));
+	if (now < target) {
+		target = now;
+	}
+	Q16_t corner = planner_corner_speed(gains->lateral_accel, planner->curvature_ahead);
+	Q16_t reach = q16_mul(q16_mul(gains->decel, Q16(PLANNER_LOOKAHEAD_IN)), Q16_FROM_INT(2));
+	Q16_t ahead = q16_sqrt(q16_add(q16_mul(corner, corner), reach));
+	if (ahead < target) {
+		target = ahead;
+	}
+
+	// Slowing down is immediate, the speed loop brakes. Speeding up is ramped, from the second
+	// update after a reset on, the first one has no dt.
+	uint32_t dt_us = planner->primed ? now_us - planner->time_prev_us : 0;
+	planner->time_prev_us = now_us;
+	planner->primed = TRUE;
+	if (target > planner->target) {
+		Q16_t step = (dt_us > PLANNER_DT_MAX_US) ? 0 : q16_mul(gains->accel, q16_div(dt_us, 1000000));
+		Q16_t ramped = q16_add(planner->target, step);
+		if (ramped < target) {
+			target = ramped;
+		}
+	}
+	planner->target = target;
+	return target;
+}
+
+// Private function definitions
+// v = sqrt(a / curvature), saturates on a straight
+static Q16_t planner_corner_speed(Q16_t lateral_accel, Q16_t curvature) {
+	if (curvature <= 0) {
+		return Q16_MAX;
+	}
+	return q16_sqrt(q16_div(lateral_accel, curvature));
+}
+
+static Q16_t planner_abs(Q16_t value) {
+	return (value < 0) ? -value : value;
+}
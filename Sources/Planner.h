@@ -0,0 +1,47 @@
+/*
+ * Planner.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_PLANNER_H_
+#define SOURCES_PLANNER_H_
+
+#include "PE_Types.h"
+#include "Fixed.h"
+
+// Public defines
+// Geometry, measure these on the car
+#define PLANNER_TURN_RADIUS_IN 16.0		// Tightest turn with the servo at a limit.
+#define PLANNER_LOOKAHEAD_IN 18.0		// Floor distance from the front axle to where the camera looks.
+#define PLANNER_VIEW_WIDTH_IN 16.0		// Width of floor the 128 pixels cover at the look-ahead.
+#define PLANNER_HISTORY 8				// Frames of line offset averaged into the curvature ahead, a power of two.
+#define PLANNER_DT_MAX_US 100000		// A longer gap between frames doesn't count towards speeding up.
+
+// Public typedefs
+typedef struct PlannerGains_t {
+	Q16_t velocity_max;		// Inches per second on straight paths
+	Q16_t lateral_accel;	// Inches per second^2 allowed in a turn
+	Q16_t decel;			// Inches per second^2 the brakes can be counted on for
+	Q16_t accel;			// Inches per second^2 the target may rise by
+	uint16_t servo_center;	// Servo commands, us
+	uint16_t servo_left;
+} PlannerGains_t;
+
+typedef struct Planner_t {
+	Q16_t offset[PLANNER_HISTORY];	// Line offsets at the look-ahead, inches
+	Q16_t offset_sum;
+	uint8_t next;
+	Q16_t curvature_now;	// 1 / inches, from the servo, positive turning left
+	Q16_t curvature_ahead;	// 1 / inches, from the line
+	Q16_t target;			// Last planned speed, inches per second
+	uint32_t time_prev_us;
+	bool primed;			// time_prev_us is valid
+} Planner_t;
+
+// Public functions
+void planner_reset(Planner_t *planner);
+Q16_t planner_update(Planner_t *planner, const PlannerGains_t *gains, int32_t offset_q8, uint16_t servo, uint32_t now_us);
+
+#endif /* SOURCES_PLANNER_H_ */
@@ -0,0 +1,116 @@
+/*
+ * SerialDMA.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include <string.h>
+#include "Cpu.h"
+#include "SerialDMA.h"
+#include "Vectors.h"
+
+#define DMAMUX_SRC_UART0_TX 3	// DMAMUX request source for UART0 transmit
+#define RING_MASK (SERIAL_TX_RING_SIZE - 1)
+
+// Public variables
+volatile uint32_t serial_tx_queued = 0;
+volatile uint32_t serial_tx_dropped = 0;
+volatile uint16_t serial_tx_high_water = 0;
+
+// Private variables
+// Free-running byte counters, only their low bits index the ring. One producer and one consumer:
+// serial_write (main loop) only moves head, serial_dma_isr only moves tail and in_flight.
+static uint8_t ring[SERIAL_TX_RING_SIZE];
+static volatile uint32_t head = 0;		// Copied in and visible to the DMA
+static volatile uint32_t tail = 0;		// Sent
+static volatile uint16_t in_flight = 0;	// Bytes handed to the DMA, 0 when it's idle
+
+// Private function declarations
+static void serial_dma_start(void);
+
+// Public function definitions
+void serial_init(void) {
+	SIM_SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+	SIM_SCGC7 |= SIM_SCGC7_DMA_MASK;
+
+	// DMA channel 1: ring[tail...] -> 8 bit UART0_D, one byte per TDRE request
+	DMAMUX0_CHCFG1 = 0;
+	DMA_DCR1 = DMA_DCR_EINT_MASK | DMA_DCR_CS_MASK | DMA_DCR_SINC_MASK
+			 | DMA_DCR_SSIZE(1) | DMA_DCR_DSIZE(1) | DMA_DCR_D_REQ_MASK;
+	DMA_DAR1 = (uint32_t)&UART0_D;
+	DMAMUX0_CHCFG1 = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(DMAMUX_SRC_UART0_TX);
+
+	// AS1 only has the receiver, the pin and the transmitter are set up here. With TDMAE, TIE
+	// makes TDRE a DMA request, it never interrupts the CPU and nothing else clears it.
+	PORTA_PCR2 = PORT_PCR_MUX(2); // UART0_TX
+	UART0_C5 |= UART0_C5_TDMAE_MASK;
+	UART0_C2 |= UART0_C2_TE_MASK | UART0_C2_TIE_MASK;
+
+	vectors_set(INT_DMA1, serial_dma_isr);
+	NVIC_ICPR = 1u << (INT_DMA1 - 16);
+	NVIC_ISER = 1u << (INT_DMA1 - 16);
+}
+
+// Queues a whole record or nothing. Main loop only, never waits for the UART or masks interrupts.
+bool serial_write(const uint8_t *data, uint16_t length) {
+	uint32_t start = head;
+	uint32_t used = start - tail;
+	if (length > SERIAL_TX_RING_SIZE - used) {
+		serial_tx_dropped += length;
+		return FALSE;
+	}
+	if (used + length > serial_tx_high_water) {
+		serial_tx_high_water = used + length;
+	}
+
+	// Copy, wrapping around the end of the ring
+	uint32_t at = start & RING_MASK;
+	uint16_t first = SERIAL_TX_RING_SIZE - at;
+	if (first > length) {
+		first = length;
+	}
+	memcpy(&ring[at], data, first);
+	memcpy(ring, data + first, length - first);
+	__asm volatile ("" ::: "memory"); // The bytes have to be in before head says so
+
+	head = start + length;
+	serial_tx_queued += length;
+	// Only serial_dma_isr starts transfers, pend it in case the DMA is idle
+	NVIC_ISPR = 1u << (INT_DMA1 - 16);
+	return TRUE;
+}
+
+// Bytes still waiting to go out
+uint16_t serial_tx_pending(void) {
+	return head - tail;
+}
+
+// A transfer is done, or serial_write pended it. Frees what was sent and starts on the rest.
+PE_ISR(serial_dma_isr) {
+	if (DMA_DSR_BCR1 & DMA_DSR_BCR_DONE_MASK) {
+		DMA_DSR_BCR1 = DMA_DSR_BCR_DONE_MASK; // Clears the interrupt and any error flags
+		tail += in_flight;
+		in_flight = 0;
+	}
+	if (in_flight == 0) {
+		serial_dma_start();
+	}
+}
+
+// Private function definitions
+// Hands the longest contiguous run of queued bytes to the DMA, from serial_dma_isr only
+static void serial_dma_start(void) {
+	uint32_t length = head - tail;
+	if (length == 0) {
+		return;
+	}
+	uint32_t at = tail & RING_MASK;
+	if (length > SERIAL_TX_RING_SIZE - at) {
+		length = SERIAL_TX_RING_SIZE - at;
+	}
+	in_flight = length;
+	DMA_SAR1 = (uint32_t)&ring[at];
+	DMA_DSR_BCR1 = DMA_DSR_BCR_BCR(length);
+	DMA_DCR1 |= DMA_DCR_ERQ_MASK; // D_REQ clears this again once BCR reaches 0
+}
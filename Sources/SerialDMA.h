@@ -0,0 +1,32 @@
+/*
+ * SerialDMA.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_SERIALDMA_H_
+#define SOURCES_SERIALDMA_H_
+
+#include "PE_Types.h"
+#include "Events.h"
+
+// Transmit ring drained to UART0 by DMA channel 1, the AS1 component only has the receiver.
+// Lock-free with a single producer, serial_write is for the main loop only.
+// NOTE: serial_init installs serial_dma_isr for INT_DMA1, vectors_init has to run first.
+
+// Public defines
+#define SERIAL_TX_RING_SIZE 1024	// Bytes, has to be a power of two.
+
+// Public variables
+extern volatile uint32_t serial_tx_queued;		// Bytes accepted into the ring.
+extern volatile uint32_t serial_tx_dropped;		// Bytes of records that didn't fit.
+extern volatile uint16_t serial_tx_high_water;	// Most bytes ever waiting in the ring.
+
+// Public functions
+void serial_init(void);
+bool serial_write(const uint8_t *data, uint16_t length);
+uint16_t serial_tx_pending(void);
+PE_ISR(serial_dma_isr);
+
+#endif /* SOURCES_SERIALDMA_H_ */
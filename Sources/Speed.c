@@ -0,0 +1,57 @@
+/*
+ * Speed.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "Speed.h"
+
+// Public function definitions
+void speed_reset(Speed_t *speed) {
+	speed->integral = 0;
+	speed->primed = FALSE;
+}
+
+// PI on the wheel speed. Positive output drives forward, negative brakes, never reverses.
+// Returns false without touching command until SPEED_PERIOD_US has passed since the last run.
+bool speed_update(Speed_t *speed, const SpeedGains_t *gains, Q16_t desired, Q16_t measured, uint32_t now_us, SpeedCommand_t *command) {
+	uint32_t dt_us = now_us - speed->time_prev_us;
+	if (speed->primed && dt_us < SPEED_PERIOD_US) {
+		return FALSE;
+	}
+	if (!speed->primed || dt_us > SPEED_DT_MAX_US) {
+		dt_us = 0;
+	}
+	speed->time_prev_us = now_us;
+	speed->primed = TRUE;
+
+	Q16_t error = q16_sub(desired, measured);
+	int32_t high = gains->duty_max;
+	int32_t low = -(int32_t)gains->brake_max;
+	int32_t p = q16_round(q16_mul(gains->kp, error));
+	int32_t u = p + (speed->integral >> 8);
+
+	// Anti-windup, only integrate while the output isn't pinned in the same direction
+	if (gains->ki > 0 && dt_us != 0 && !((u >= high && error > 0) || (u <= low && error < 0))) {
+		Q16_t step = q16_mul(gains->ki, q16_mul(error, q16_div(dt_us, 1000000)));
+		int32_t integral = speed->integral + (step >> 8);
+		// Keep the I term alone within the output range too
+		speed->integral = (integral > (high << 8)) ? (high << 8) : (integral < (low << 8)) ? (low << 8) : integral;
+		u = p + (speed->integral >> 8);
+	}
+	else if (gains->ki <= 0) {
+		speed->integral = 0;
+	}
+
+	u = (u > high) ? high : (u < low) ? low : u;
+	if (u >= 0) {
+		command->direction = MotorDir_Forward;
+		command->duty = u;
+	}
+	else {
+		command->direction = gains->brake;
+		command->duty = -u;
+	}
+	return TRUE;
+}
@@ -0,0 +1,43 @@
+/*
+ * Speed.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_SPEED_H_
+#define SOURCES_SPEED_H_
+
+#include "PE_Types.h"
+#include "Fixed.h"
+#include "Motors.h"
+
+// Public defines
+#define SPEED_PERIOD_US 10000			// The loop runs at 100Hz, from whichever frame is due.
+#define SPEED_DT_MAX_US 100000			// A longer gap skips the integral for that update.
+
+// Public typedefs
+typedef struct SpeedGains_t {
+	Q16_t kp;				// Duty counts per inch per second
+	Q16_t ki;				// Duty counts per inch
+	uint16_t duty_max;		// Forward duty limit
+	uint16_t brake_max;		// Brake duty limit, 0 = coast when too fast
+	MotorDir_t brake;		// MotorDir_Brake, MotorDir_BrakeTop or MotorDir_BrakeBottom
+} SpeedGains_t;
+
+typedef struct Speed_t {
+	int32_t integral;		// I term, duty counts Q8
+	uint32_t time_prev_us;
+	bool primed;			// time_prev_us is valid
+} Speed_t;
+
+typedef struct SpeedCommand_t {
+	MotorDir_t direction;
+	uint16_t duty;
+} SpeedCommand_t;
+
+// Public functions
+void speed_reset(Speed_t *speed);
+bool speed_update(Speed_t *speed, const SpeedGains_t *gains, Q16_t desired, Q16_t measured, uint32_t now_us, SpeedCommand_t *command);
+
+#endif /* SOURCES_SPEED_H_ */
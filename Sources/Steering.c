@@ -0,0 +1,99 @@
+/*
+ * Steering.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "Steering.h"
+
+// Private function declarations
+static int32_t steering_clamp(int32_t value, int32_t low, int32_t high);
+
+// Public function definitions
+// Forget the line history, the next update only runs P. The command is kept, so the next
+// update still slews from where the servo is.
+void steering_reset(Steering_t *steering) {
+	steering->derivative = 0;
+	steering->integral = 0;
+	steering->primed = FALSE;
+}
+
+// Scales kp and kd by the schedule at this speed, linear between breakpoints, flat past the last
+void steering_schedule(const SteeringSchedule_t *schedule, Q16_t velocity, SteeringGains_t *gains) {
+	Q16_t position = q16_div(velocity < 0 ? 0 : velocity, Q16_FROM_INT(STEERING_SCHEDULE_STEP));
+	int index = position >> 16;
+	Q15_t fraction = (position & 0xFFFF) >> 1;
+	if (index >= STEERING_SCHEDULE_POINTS - 1) {
+		index = STEERING_SCHEDULE_POINTS - 2;
+		fraction = Q15_ONE;
+	}
+	gains->kp = q16_mul(gains->kp, q16_lerp(schedule->kp[index], schedule->kp[index + 1], fraction));
+	gains->kd = q16_mul(gains->kd, q16_lerp(schedule->kd[index], schedule->kd[index + 1], fraction));
+}
+
+// PID on the line center with the derivative on the measurement, so a setpoint change
+// doesn't kick the servo. dt comes from the frame timestamps instead of a fixed period.
+uint16_t steering_update(Steering_t *steering, const SteeringGains_t *gains, int32_t setpoint_q8, int32_t center_q8, uint32_t now_us) {
+	Q16_t error = (setpoint_q8 - center_q8) << 8;	// Pixels
+	Q16_t center = center_q8 << 8;
+	uint32_t dt_us = now_us - steering->time_prev_us;
+
+	if (steering->command == 0) {
+		steering->command = gains->center; // Never updated yet
+	}
+	if (steering->period_us == 0) {
+		steering->period_us = STEERING_PERIOD_US;
+	}
+	if (!steering->primed || dt_us == 0 || dt_us > STEERING_DT_MAX_US) {
+		// Nothing to differentiate against, or too old to trust
+		steering->derivative = 0;
+		dt_us = 0;
+	}
+	else {
+		steering->period_us = dt_us;
+		// pixels per second = dQ8 / 256 * 1e6 / dt = dQ8 * 15625 / (dt * 4)
+		Q16_t raw = q16_div((center_q8 - (steering->center_prev >> 8)) * 15625, dt_us * 4);
+		steering->derivative = q16_lerp(raw, steering->derivative, gains->d_filter);
+	}
+	steering->center_prev = center;
+	steering->time_prev_us = now_us;
+	steering->primed = TRUE;
+
+	Q16_t p = q16_mul(gains->kp, error);
+	Q16_t d = q16_mul(gains->kd, steering->derivative);
+	Q16_t i = 0;
+	if (gains->ki > 0) {
+		// Anti-windup, the integral never holds more than STEERING_I_LIMIT_US worth of command
+		Q16_t limit = q16_div(Q16_FROM_INT(STEERING_I_LIMIT_US), gains->ki);
+		Q16_t integral = q16_add(steering->integral, q16_mul(error, q16_div(dt_us, 1000000)));
+		steering->integral = (integral > limit) ? limit : (integral < -limit) ? -limit : integral;
+		i = q16_mul(gains->ki, steering->integral);
+	}
+	else {
+		steering->integral = 0;
+	}
+
+	// d(error)/dt is -d(center)/dt
+	int32_t target = gains->center + q16_round(q16_sub(q16_add(p, i), d));
+	int32_t low = (gains->right < gains->left) ? gains->right : gains->left;
+	int32_t high = (gains->right < gains->left) ? gains->left : gains->right;
+	target = steering_clamp(target, low, high);
+
+	// Rate limit against the previous command, over one frame period if there's no dt
+	if (gains->slew != 0) {
+		uint32_t slew_us = dt_us ? dt_us : steering->period_us;
+		int32_t step = ((uint32_t)gains->slew * (slew_us / 10) + 50000) / 100000; // In 10us so 60000 us/s over 100ms fits
+		if (step < 1) {
+			step = 1;
+		}
+		target = steering_clamp(target, steering->command - step, steering->command + step);
+	}
+	steering->command = target;
+	return (uint16_t)target;
+}
+
+// Private function definitions
+static int32_t steering_clamp(int32_t value, int32_t low, int32_t high) {
+	return (value < low) ? low : (value > high) ? high : value;
+}
@@ -0,0 +1,54 @@
+/*
+ * Steering.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_STEERING_H_
+#define SOURCES_STEERING_H_
+
+#include "PE_Types.h"
+#include "Fixed.h"
+
+// Public defines
+#define STEERING_DT_MAX_US 100000		// A longer gap between frames restarts the derivative.
+#define STEERING_PERIOD_US 10000		// Frame period the slew limit assumes until one is measured.
+#define STEERING_I_LIMIT_US 200			// Most the integral term may add to the command.
+#define STEERING_SCHEDULE_POINTS 5		// Gain schedule breakpoints, the first at standstill.
+#define STEERING_SCHEDULE_STEP 30		// Inches per second between breakpoints.
+
+// Public typedefs
+typedef struct SteeringGains_t {
+	Q16_t kp;				// us per pixel of error
+	Q16_t ki;				// us per pixel second
+	Q16_t kd;				// us per pixel per second of line movement
+	Q15_t d_filter;			// Weight of the previous derivative, 0 = unfiltered
+	uint16_t slew;			// Most the command may move, us per second, 0 = unlimited
+	uint16_t center;		// Servo commands, us
+	uint16_t left;
+	uint16_t right;
+} SteeringGains_t;
+
+// Multipliers on Kps and Kds, interpolated by speed
+typedef struct SteeringSchedule_t {
+	Q16_t kp[STEERING_SCHEDULE_POINTS];
+	Q16_t kd[STEERING_SCHEDULE_POINTS];
+} SteeringSchedule_t;
+
+typedef struct Steering_t {
+	Q16_t center_prev;		// Last measured line center, pixels
+	Q16_t derivative;		// Filtered line movement, pixels per second
+	Q16_t integral;			// Pixel seconds
+	int32_t command;		// Last servo command, us, kept across steering_reset
+	uint32_t time_prev_us;
+	uint32_t period_us;		// Last measured frame period, slew limits the first update after a reset
+	bool primed;			// center_prev and time_prev_us are valid
+} Steering_t;
+
+// Public functions
+void steering_reset(Steering_t *steering);
+void steering_schedule(const SteeringSchedule_t *schedule, Q16_t velocity, SteeringGains_t *gains);
+uint16_t steering_update(Steering_t *steering, const SteeringGains_t *gains, int32_t setpoint_q8, int32_t center_q8, uint32_t now_us);
+
+#endif /* SOURCES_STEERING_H_ */
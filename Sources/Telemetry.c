@@ -0,0 +1,302 @@
+/*
+ * Telemetry.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include <string.h>
+#include "Cpu.h"
+#include "Telemetry.h"
+#include "SerialDMA.h"
+#include "Params.h"
+#include "FrameDelta.h"
+#include "Trace.h"
+
+// Public variables
+volatile uint32_t telemetry_packets_sent = 0;
+volatile uint32_t telemetry_packets_dropped = 0;
+volatile uint32_t telemetry_commands_rejected = 0;
+
+// Private variables
+static uint8_t seq = 0;
+static uint16_t divider[TelemChannel_Count] = {
+	[TelemChannel_Status] = TELEM_DEFAULT_STATUS_DIVIDER,
+	[TelemChannel_BinaryFrame] = TELEM_DEFAULT_BINARY_DIVIDER,
+};
+static uint16_t countdown[TelemChannel_Count] = {0};
+static uint8_t rx[TELEM_RX_BUFFER];
+static uint8_t rx_length = 0;
+static bool rx_overflow = FALSE;
+
+// CRC-16/CCITT-FALSE a nibble at a time, 32 bytes of table instead of 512
+static const uint16_t crc16_nibble[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+// Private function declarations
+static void telemetry_command(const uint8_t *encoded, uint8_t length);
+static void telemetry_ack(uint8_t type, uint8_t command_seq, TelemAckStatus_t status);
+static void telemetry_param(ParamId_t id);
+
+// Public function definitions
+// Frames payload as [type][seq][payload][crc16], COBS encodes it and sends it with a 0x00 delimiter
+bool telemetry_send(TelemType_t type, const void *payload, uint8_t length) {
+	uint8_t packet[TELEM_MAX_PACKET];
+	uint8_t encoded[TELEM_MAX_ENCODED];
+
+	if (length > TELEM_MAX_PAYLOAD) {
+		return FALSE;
+	}
+	packet[0] = type;
+	packet[1] = seq++;
+	memcpy(&packet[2], payload, length);
+	uint16_t crc = telemetry_crc16(TELEM_CRC_INIT, packet, length + 2);
+	packet[length + 2] = crc & 0xFF;
+	packet[length + 3] = crc >> 8;
+
+	uint16_t size = telemetry_cobs_encode(packet, length + 4, encoded);
+	encoded[size++] = 0x00;
+	if (!serial_write(encoded, size)) {
+		telemetry_packets_dropped++;
+		return FALSE;
+	}
+	telemetry_packets_sent++;
+	return TRUE;
+}
+
+void telemetry_send_binary(uint32_t timestamp_us, const uint32_t *bits) {
+	TelemFrameBinary_t packet;
+	packet.timestamp_us = timestamp_us;
+	memcpy(packet.bits, bits, TELEM_BINARY_BYTES); // Little-endian words are already pixel ordered bytes
+	telemetry_send(TelemType_FrameBinary, &packet, sizeof(packet));
+}
+
+void telemetry_send_gray(uint32_t timestamp_us, const uint16_t *frame) {
+	TelemFrameGray_t packet;
+	packet.timestamp_us = timestamp_us;
+	for (int i = 0; i < TELEM_GRAY_PIXELS; ++i) {
+		packet.pixel[i] = frame[i] >> 8;
+	}
+	telemetry_send(TelemType_FrameGray, &packet, sizeof(packet));
+}
+
+// Sends the frame as changes in its edge positions, see FrameDelta.h
+void telemetry_send_delta(uint32_t timestamp_us, const uint32_t *bits) {
+	static FrameDelta_t encoder;
+	FrameDeltaPacket_t packet;
+	uint8_t length;
+
+	TelemType_t type = framedelta_encode(&encoder, timestamp_us, bits, &packet, &length);
+	if (!telemetry_send(type, &packet, length)) {
+		framedelta_lost(&encoder); // Resync with a keyframe
+	}
+}
+
+// values holds one word per scalar channel (TELEM_FIRST_SAMPLE...), only the ones in mask are sent
+void telemetry_send_samples(uint32_t timestamp_us, uint16_t mask, const uint16_t *values) {
+	TelemSamples_t packet;
+	uint8_t count = 0;
+
+	packet.timestamp_us = timestamp_us;
+	packet.mask = 0;
+	for (int channel = TELEM_FIRST_SAMPLE; channel < TelemChannel_Count; ++channel) {
+		if (mask & TELEM_CHANNEL_BIT(channel)) {
+			packet.mask |= TELEM_CHANNEL_BIT(channel);
+			packet.value[count++] = values[channel - TELEM_FIRST_SAMPLE];
+		}
+	}
+	if (count == 0) {
+		return;
+	}
+	telemetry_send(TelemType_Samples, &packet, sizeof(packet) - sizeof(packet.value) + count * sizeof(uint16_t));
+}
+
+// Sends channel every divider frames starting with the next one, 0 turns it off
+bool telemetry_subscribe(TelemChannel_t channel, uint16_t frames) {
+	if (channel >= TelemChannel_Count) {
+		return FALSE;
+	}
+	EnterCritical();
+	divider[channel] = frames;
+	countdown[channel] = 0;
+	ExitCritical();
+	return TRUE;
+}
+
+// Call once per processed frame, returns TELEM_CHANNEL_BIT of every channel to send for it
+uint16_t telemetry_frame_due(void) {
+	uint16_t due = 0;
+
+	for (int channel = 0; channel < TelemChannel_Count; ++channel) {
+		if (divider[channel] == 0) {
+			continue;
+		}
+		if (countdown[channel] == 0) {
+			countdown[channel] = divider[channel];
+			due |= TELEM_CHANNEL_BIT(channel);
+		}
+		countdown[channel]--;
+	}
+	return due;
+}
+
+// Collects host commands from the AS1 receive path, call it from the main loop
+void telemetry_poll(void) {
+	AS1_TComData c;
+
+	while (AS1_RecvChar(&c) == ERR_OK) {
+		if (c != 0x00) {
+			if (rx_length < TELEM_RX_BUFFER) {
+				rx[rx_length++] = c;
+			}
+			else {
+				rx_overflow = TRUE;
+			}
+			continue;
+		}
+		// Delimiter, the packet is complete
+		if (rx_overflow) {
+			telemetry_commands_rejected++;
+		}
+		else if (rx_length > 0) {
+			telemetry_command(rx, rx_length);
+		}
+		rx_length = 0;
+		rx_overflow = FALSE;
+	}
+}
+
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t *data, uint16_t length) {
+	for (uint16_t i = 0; i < length; ++i) {
+		crc = (crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] >> 4)];
+		crc = (crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] & 0x0F)];
+	}
+	return crc;
+}
+
+// Consistent overhead byte stuffing, removes every 0x00 from data. Returns the encoded length.
+uint16_t telemetry_cobs_encode(const uint8_t *data, uint16_t length, uint8_t *out) {
+	uint16_t code_at = 0;
+	uint16_t size = 1;
+	uint8_t code = 1;
+
+	for (uint16_t i = 0; i < length; ++i) {
+		if (data[i] == 0) {
+			out[code_at] = code;
+			code_at = size++;
+			code = 1;
+			continue;
+		}
+		out[size++] = data[i];
+		if (++code == 0xFF) {
+			out[code_at] = code;
+			code_at = size++;
+			code = 1;
+		}
+	}
+	out[code_at] = code;
+	return size;
+}
+
+// Undoes telemetry_cobs_encode, data must not include the delimiter. Returns the decoded length, 0 if malformed.
+uint16_t telemetry_cobs_decode(const uint8_t *data, uint16_t length, uint8_t *out) {
+	uint16_t size = 0;
+	uint16_t i = 0;
+
+	while (i < length) {
+		uint8_t code = data[i++];
+		if (code == 0 || i + code - 1 > length) {
+			return 0;
+		}
+		for (uint8_t n = 1; n < code; ++n) {
+			out[size++] = data[i++];
+		}
+		if (code < 0xFF && i < length) {
+			out[size++] = 0x00;
+		}
+	}
+	return size;
+}
+
+// Private function definitions
+static void telemetry_command(const uint8_t *encoded, uint8_t length) {
+	uint8_t packet[TELEM_RX_BUFFER];
+	uint16_t size = telemetry_cobs_decode(encoded, length, packet);
+
+	// Smallest packet is type, seq and the crc
+	if (size < 4 || telemetry_crc16(TELEM_CRC_INIT, packet, size - 2) != (packet[size - 2] | (packet[size - 1] << 8))) {
+		telemetry_commands_rejected++;
+		return;
+	}
+	uint8_t type = packet[0];
+	uint8_t command_seq = packet[1];
+	const uint8_t *payload = &packet[2];
+	uint16_t payload_length = size - 4;
+	TelemAckStatus_t status = TelemAck_BadCommand;
+
+	switch (type) {
+	case TelemType_Subscribe:
+		if (payload_length == sizeof(TelemSubscribe_t)) {
+			TelemSubscribe_t subscribe;
+			memcpy(&subscribe, payload, sizeof(subscribe));
+			status = telemetry_subscribe(subscribe.channel, subscribe.divider) ? TelemAck_Ok : TelemAck_BadChannel;
+		}
+		break;
+	case TelemType_ParamGet:
+		if (payload_length == sizeof(TelemParamGet_t)) {
+			status = params_info(payload[0]) ? TelemAck_Ok : TelemAck_BadParam;
+		}
+		break;
+	case TelemType_ParamSet:
+		if (payload_length == sizeof(TelemParamSet_t)) {
+			TelemParamSet_t set;
+			memcpy(&set, payload, sizeof(set));
+			status = params_set(set.id, set.value);
+		}
+		break;
+	case TelemType_TraceDump:
+		if (payload_length == 0) {
+			trace_dump_start();
+			status = TelemAck_Ok;
+		}
+		break;
+	case TelemType_TraceResume:
+		if (payload_length == 0) {
+			trace_resume();
+			status = TelemAck_Ok;
+		}
+		break;
+	default:
+		break;
+	}
+	if (status != TelemAck_Ok) {
+		telemetry_commands_rejected++;
+	}
+	telemetry_ack(type, command_seq, status);
+	// Get and set both answer with the value the controller will use
+	if ((type == TelemType_ParamGet || type == TelemType_ParamSet) && payload_length > 0 && params_info(payload[0])) {
+		telemetry_param(payload[0]);
+	}
+}
+
+static void telemetry_ack(uint8_t type, uint8_t command_seq, TelemAckStatus_t status) {
+	TelemAck_t ack;
+	ack.type = type;
+	ack.seq = command_seq;
+	ack.status = status;
+	telemetry_send(TelemType_Ack, &ack, sizeof(ack));
+}
+
+static void telemetry_param(ParamId_t id) {
+	const ParamInfo_t *info = params_info(id);
+	TelemParam_t param;
+	param.id = id;
+	param.type = info->type;
+	param.value = params_get(id);
+	param.min = info->min;
+	param.max = info->max;
+	param.fallback = info->fallback;
+	telemetry_send(TelemType_Param, &param, sizeof(param));
+}
@@ -0,0 +1,40 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_TELEMETRY_H_
+#define SOURCES_TELEMETRY_H_
+
+#include "PE_Types.h"
+#include "Events.h"
+#include "TelemetryFormat.h"
+
+// Public defines
+// Power-up subscriptions, the host changes them with TelemType_Subscribe.
+// At 9600 baud the link moves ~960 bytes/s, a status packet is ~40 bytes on the wire.
+#define TELEM_DEFAULT_STATUS_DIVIDER 32
+#define TELEM_DEFAULT_BINARY_DIVIDER 128
+#define TELEM_RX_BUFFER 16			// Longest command packet, COBS encoded.
+
+// Public variables
+extern volatile uint32_t telemetry_packets_sent;
+extern volatile uint32_t telemetry_packets_dropped;
+extern volatile uint32_t telemetry_commands_rejected;	// Bad CRC, bad framing or unknown command.
+
+// Public functions
+bool telemetry_send(TelemType_t type, const void *payload, uint8_t length);
+void telemetry_send_binary(uint32_t timestamp_us, const uint32_t *bits);
+void telemetry_send_gray(uint32_t timestamp_us, const uint16_t *frame);
+void telemetry_send_delta(uint32_t timestamp_us, const uint32_t *bits);
+void telemetry_send_samples(uint32_t timestamp_us, uint16_t mask, const uint16_t *values);
+bool telemetry_subscribe(TelemChannel_t channel, uint16_t frames);
+uint16_t telemetry_frame_due(void);
+void telemetry_poll(void);
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t *data, uint16_t length);
+uint16_t telemetry_cobs_encode(const uint8_t *data, uint16_t length, uint8_t *out);
+uint16_t telemetry_cobs_decode(const uint8_t *data, uint16_t length, uint8_t *out);
+
+#endif /* SOURCES_TELEMETRY_H_ */
@@ -0,0 +1,242 @@
+/*
+ * TelemetryFormat.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Wire format of the telemetry link, shared with the host tools so keep it free of
+ *  Processor Expert includes. Everything is little-endian.
+ *
+ *  Packet:  [type][seq][payload ...][crc16 lo][crc16 hi]
+ *           crc16 is CRC-16/CCITT-FALSE over type, seq and payload.
+ *  On the wire every packet is COBS encoded and followed by a single 0x00 delimiter.
+ *  Commands from the host use the same framing, the car answers each one with TelemAck_t.
+ */
+
+#ifndef SOURCES_TELEMETRYFORMAT_H_
+#define SOURCES_TELEMETRYFORMAT_H_
+
+#include <stdint.h>
+
+// Public defines
+#define TELEM_MAX_PAYLOAD 136
+#define TELEM_MAX_PACKET (2 + TELEM_MAX_PAYLOAD + 2)
+#define TELEM_MAX_ENCODED (TELEM_MAX_PACKET + TELEM_MAX_PACKET / 254 + 2) // COBS overhead + delimiter
+#define TELEM_CRC_INIT 0xFFFF
+#define TELEM_GRAY_PIXELS 128		// Grayscale frames are sent at full resolution, 8 bits per pixel.
+#define TELEM_BINARY_BYTES 16		// 128 pixels, bit (i % 8) of byte (i / 8) set for white.
+#define TELEM_DELTA_MAX_EDGES 32	// Frames with more edges than this go out as keyframes.
+#define TELEM_DELTA_NIBBLES 0x80	// TelemFrameDelta_t.count flag, data holds 4 bit edge moves.
+#define TELEM_KEYFRAME_EVERY 32		// Delta frames between keyframes.
+#define TELEM_TRACE_CHUNK 15		// Trace records per TelemTraceChunk_t.
+
+// Public typedefs
+typedef enum TelemType_t {
+	TelemType_Status = 0x01,		// TelemStatus_t
+	TelemType_FrameBinary = 0x02,	// TelemFrameBinary_t
+	TelemType_FrameGray = 0x03,		// TelemFrameGray_t
+	TelemType_Samples = 0x04,		// TelemSamples_t
+	TelemType_Ack = 0x05,			// TelemAck_t
+	TelemType_Param = 0x06,			// TelemParam_t, answer to ParamGet and ParamSet
+	TelemType_FrameKey = 0x07,		// TelemFrameKey_t
+	TelemType_FrameDelta = 0x08,	// TelemFrameDelta_t
+	TelemType_TraceChunk = 0x09,	// TelemTraceChunk_t
+	// Host to car
+	TelemType_Subscribe = 0x80,		// TelemSubscribe_t
+	TelemType_ParamGet = 0x81,		// TelemParamGet_t
+	TelemType_ParamSet = 0x82,		// TelemParamSet_t
+	TelemType_TraceDump = 0x83,		// No payload, freezes the trace and sends it
+	TelemType_TraceResume = 0x84,	// No payload, clears the trace and records again
+} TelemType_t;
+
+// Everything the host can subscribe to. The scalar channels share one TelemSamples_t per frame.
+typedef enum TelemChannel_t {
+	TelemChannel_Status = 0,		// TelemStatus_t
+	TelemChannel_RawFrame,			// TelemFrameGray_t
+	TelemChannel_BinaryFrame,		// TelemFrameBinary_t
+	TelemChannel_DeltaFrame,		// TelemFrameKey_t and TelemFrameDelta_t
+	TelemChannel_LineCenter,		// uint16, pixels Q8
+	TelemChannel_SteeringError,		// int16, pixels Q8
+	TelemChannel_ServoCommand,		// uint16, us
+	TelemChannel_Velocity,			// int16, inches per second Q8
+	TelemChannel_VelocityDesired,	// int16, inches per second Q8
+	TelemChannel_MotorDuty,			// uint16
+	TelemChannel_Count
+} TelemChannel_t;
+
+// Tunable parameters, see Params.c for ranges and defaults
+typedef enum ParamId_t {
+	Param_Kps = 0,					// P constant for steering
+	Param_Kds,						// D constant for steering, per pixel per second
+	Param_Kpv,						// P constant for velocity, duty per inch per second
+	Param_Reserved3,				// Was Ka, which nothing read. Kept so the ids after it don't move
+	Param_Bv,						// IIR ratio for velocity smoothing
+	Param_Bs,						// IIR ratio for steering smoothing
+	Param_VelocityMax,				// Inches per second on straight paths
+	Param_ServoCenter,				// Servo commands, us
+	Param_ServoLeft,
+	Param_ServoRight,
+	Param_Kis,						// I constant for steering
+	Param_ServoSlew,				// Fastest servo command change, us per second, 0 = unlimited
+	Param_Kiv,						// I constant for velocity
+	Param_DutyMax,					// Motor duty limits, 0xFFFF = full
+	Param_BrakeMax,
+	Param_LateralAccel,				// Speed planner limits, inches per second^2
+	Param_Decel,
+	Param_Accel,
+	Param_KpsSchedule0,				// Kps multiplier at 0, 30, 60, 90 and 120+ inches per second
+	Param_KpsSchedule1,
+	Param_KpsSchedule2,
+	Param_KpsSchedule3,
+	Param_KpsSchedule4,
+	Param_KdsSchedule0,				// Kds multiplier, same breakpoints
+	Param_KdsSchedule1,
+	Param_KdsSchedule2,
+	Param_KdsSchedule3,
+	Param_KdsSchedule4,
+	Param_DiffGain,					// Electronic differential, 1 = wheels follow their own arcs, 0 = off
+	Param_MotorRise,				// Motor command shaper, duty per ms (jerk per ms^2), 0 = unlimited
+	Param_MotorFall,
+	Param_MotorJerk,
+	Param_BrakeRise,				// Same for braking, no jerk limit
+	Param_Count
+} ParamId_t;
+
+// In-RAM trace, see Trace.h
+typedef enum TraceEvent_t {
+	Trace_Boot = 1,				// a8: RCM_SRS0, a16: RCM_SRS1 << 8
+	Trace_FrameStart,			// a16: frame count
+	Trace_FrameDone,			// a16: frame count
+	Trace_Pixel,				// a8: index, a16: sample
+	Trace_Capture,				// a16: Cap1 capture value
+	Trace_Line,					// a8: LineClass_t, a16: dark runs in the frame
+	Trace_Steer,				// a8: line center in whole pixels, a16: servo command
+	Trace_Speed,				// a8: MotorDir_t, a16: motor duty
+	Trace_Fault,				// a8: TraceFault_t, a16: low half of the faulting pc
+} TraceEvent_t;
+
+typedef enum TraceFault_t {
+	TraceFault_None = 0,
+	TraceFault_Command,			// Frozen by TelemType_TraceDump.
+	TraceFault_LineLost,		// No line for TRACE_LOST_US after following it, off the track.
+	TraceFault_HardFault,
+} TraceFault_t;
+
+typedef struct __attribute__((packed)) TraceRecord_t {
+	uint32_t ticks;				// Bus clock ticks, timebase_ticks().
+	uint8_t event;				// TraceEvent_t.
+	uint8_t a8;
+	uint16_t a16;
+} TraceRecord_t;
+
+typedef enum ParamType_t {
+	ParamType_Q16 = 0,				// Q16.16 on the car, float on the wire
+	ParamType_U16,
+} ParamType_t;
+
+#define TELEM_CHANNEL_BIT(channel) (1u << (channel))
+#define TELEM_FIRST_SAMPLE TelemChannel_LineCenter
+
+typedef enum TelemAckStatus_t {
+	TelemAck_Ok = 0,
+	TelemAck_BadCommand,			// Unknown type or wrong payload length.
+	TelemAck_BadChannel,
+	TelemAck_BadParam,				// No parameter with that id.
+	TelemAck_OutOfRange,			// Value outside the parameter's min and max, nothing changed.
+} TelemAckStatus_t;
+
+// Controller state, one per processed frame (or fewer, see decimation)
+typedef struct __attribute__((packed)) TelemStatus_t {
+	uint32_t timestamp_us;		// Timebase at the start of processing.
+	uint32_t frame;				// linecam_frame_count.
+	uint16_t line_center_q8;	// Pixels, Q8.
+	int16_t error_q8;			// desired center - line center, pixels, Q8.
+	uint16_t servo_us;			// Servo command.
+	int16_t velocity_q8;		// Measured, inches per second, Q8.
+	int16_t velocity_desired_q8;
+	uint16_t motor_duty;		// motors_get_duty().
+	uint16_t threshold;			// Camera threshold used for this frame.
+	uint16_t exposure_us;
+	uint8_t line_class;			// LineClass_t.
+	uint8_t line_confidence;
+} TelemStatus_t;
+
+typedef struct __attribute__((packed)) TelemFrameBinary_t {
+	uint32_t timestamp_us;
+	uint8_t bits[TELEM_BINARY_BYTES];
+} TelemFrameBinary_t;
+
+typedef struct __attribute__((packed)) TelemFrameGray_t {
+	uint32_t timestamp_us;
+	uint8_t pixel[TELEM_GRAY_PIXELS];	// Top 8 bits of every sample.
+} TelemFrameGray_t;
+
+// Binary frames as edge lists. Pixel -1 counts as white and every edge flips the colour,
+// so edge positions alone rebuild the frame. A keyframe starts the stream, every other frame
+// is relative to the one before it: index has to be the previous index + 1 or the decoder
+// waits for the next keyframe.
+typedef struct __attribute__((packed)) TelemFrameKey_t {
+	uint32_t timestamp_us;
+	uint16_t index;
+	uint8_t bits[TELEM_BINARY_BYTES];
+} TelemFrameKey_t;
+
+typedef struct __attribute__((packed)) TelemFrameDelta_t {
+	uint16_t index;
+	uint16_t dt_us;				// Since the previous frame.
+	uint8_t count;				// Edges, | TELEM_DELTA_NIBBLES when data holds moves.
+	// Without TELEM_DELTA_NIBBLES: count absolute edge positions.
+	// With: the edge count didn't change and data holds one signed 4 bit move per edge,
+	//       edge i in the low nibble of data[i / 2] for even i, the high nibble for odd i.
+	uint8_t data[TELEM_DELTA_MAX_EDGES];
+} TelemFrameDelta_t;
+
+// One 16 bit word per bit set in mask, lowest channel first
+typedef struct __attribute__((packed)) TelemSamples_t {
+	uint32_t timestamp_us;
+	uint16_t mask;				// TELEM_CHANNEL_BIT of every channel present.
+	uint16_t value[TelemChannel_Count - TELEM_FIRST_SAMPLE];
+} TelemSamples_t;
+
+// Send channel every divider processed frames, 0 turns it off
+typedef struct __attribute__((packed)) TelemSubscribe_t {
+	uint8_t channel;			// TelemChannel_t.
+	uint16_t divider;
+} TelemSubscribe_t;
+
+typedef struct __attribute__((packed)) TelemParamGet_t {
+	uint8_t id;					// ParamId_t.
+} TelemParamGet_t;
+
+typedef struct __attribute__((packed)) TelemParamSet_t {
+	uint8_t id;
+	float value;				// Rounded to the nearest integer for ParamType_U16.
+} TelemParamSet_t;
+
+// value is what the controller will use from the next frame on
+typedef struct __attribute__((packed)) TelemParam_t {
+	uint8_t id;
+	uint8_t type;				// ParamType_t.
+	float value;
+	float min;
+	float max;
+	float fallback;				// Power-up default.
+} TelemParam_t;
+
+// Frozen trace, oldest record first. record[i] is record number first + i of total.
+typedef struct __attribute__((packed)) TelemTraceChunk_t {
+	uint16_t first;
+	uint16_t total;
+	uint8_t fault;				// TraceFault_t that froze it.
+	uint8_t count;				// Records in this chunk.
+	uint32_t tick_hz;
+	TraceRecord_t record[TELEM_TRACE_CHUNK];
+} TelemTraceChunk_t;
+
+typedef struct __attribute__((packed)) TelemAck_t {
+	uint8_t type;				// Type and seq of the command being answered.
+	uint8_t seq;
+	uint8_t status;				// TelemAckStatus_t.
+} TelemAck_t;
+
+#endif /* SOURCES_TELEMETRYFORMAT_H_ */
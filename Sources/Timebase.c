@@ -0,0 +1,43 @@
+/*
+ * Timebase.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "Cpu.h"
+#include "Timebase.h"
+
+// Private variables
+static uint32_t last_ticks = 0;
+static uint32_t last_us = 0;
+static uint32_t remainder = 0;	// Leftover of the last conversion, in 1/1000 ticks
+
+// Public function definitions
+// PIT channel 1 free-runs from the bus clock with no interrupt, channel 0 belongs to SI_Timer
+void timebase_init(void) {
+	PIT_LDVAL1 = 0xFFFFFFFFu;
+	PIT_TCTRL1 = PIT_TCTRL_TEN_MASK;
+}
+
+// Bus clock ticks counting up, wraps every 2^32 ticks (about 200 s)
+uint32_t timebase_ticks(void) {
+	return ~PIT_CVAL1;
+}
+
+// Microseconds since timebase_init, wraps after about 71 minutes. Has to be called at least once per tick wrap.
+uint32_t timebase_us(void) {
+	uint32_t us;
+
+	EnterCritical();
+	uint32_t now = timebase_ticks();
+	uint32_t elapsed = now - last_ticks;
+	last_ticks = now;
+	// Whole milliseconds first so the scaling by 1000 can't overflow
+	uint32_t scaled = (elapsed % TIMEBASE_TICKS_PER_MS) * 1000u + remainder;
+	last_us += (elapsed / TIMEBASE_TICKS_PER_MS) * 1000u + scaled / TIMEBASE_TICKS_PER_MS;
+	remainder = scaled % TIMEBASE_TICKS_PER_MS;
+	us = last_us;
+	ExitCritical();
+	return us;
+}
@@ -0,0 +1,21 @@
+/*
+ * Timebase.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_TIMEBASE_H_
+#define SOURCES_TIMEBASE_H_
+
+#include "PE_Types.h"
+
+// Public defines
+#define TIMEBASE_TICKS_PER_MS (CPU_BUS_CLK_HZ / 1000u)
+
+// Public functions
+void timebase_init(void);
+uint32_t timebase_ticks(void);
+uint32_t timebase_us(void);
+
+#endif /* SOURCES_TIMEBASE_H_ */
@@ -0,0 +1,109 @@
+/*
+ * Trace.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include <string.h>
+#include "Trace.h"
+#include "Telemetry.h"
+#include "SerialDMA.h"
+
+#define TRACE_MAGIC 0x54524345u	// "TRCE"
+
+// Public variables
+// .noinit is left alone by startup, see ProcessorExpert.ld
+Trace_t trace_buffer __attribute__((section(".noinit")));
+
+// Private variables
+static bool dumping = FALSE;
+static uint16_t dump_next = 0;		// Next record to send, counted from the oldest
+
+// Private function declarations
+static void trace_hardfault(uint32_t pc);
+
+// Public function definitions
+// Keeps a trace frozen before the reset, otherwise starts an empty one
+void trace_init(void) {
+	if (trace_buffer.magic != TRACE_MAGIC || trace_buffer.fault == TraceFault_None) {
+		trace_buffer.magic = TRACE_MAGIC;
+		trace_buffer.head = 0;
+		trace_buffer.fault = TraceFault_None;
+	}
+	trace(Trace_Boot, RCM_SRS0, RCM_SRS1 << 8);
+}
+
+// Records the fault and freezes, the first fault wins
+void trace_fault(TraceFault_t fault, uint32_t pc) {
+	if (trace_buffer.fault != TraceFault_None) {
+		return;
+	}
+	trace(Trace_Fault, fault, (uint16_t)pc);
+	trace_buffer.fault = fault;
+}
+
+void trace_resume(void) {
+	EnterCritical();
+	dumping = FALSE;
+	trace_buffer.head = 0;
+	trace_buffer.fault = TraceFault_None;
+	ExitCritical();
+}
+
+// Freezes the trace and starts sending it from trace_dump_poll
+void trace_dump_start(void) {
+	trace_fault(TraceFault_Command, 0);
+	dumping = TRUE;
+	dump_next = 0;
+}
+
+// Sends the next chunk of a dump whenever the transmit ring has room, call it from the main loop
+void trace_dump_poll(void) {
+	if (!dumping || serial_tx_pending() > SERIAL_TX_RING_SIZE - TELEM_MAX_ENCODED) {
+		return;
+	}
+	uint32_t head = trace_buffer.head;
+	uint16_t total = (head < TRACE_RECORDS) ? head : TRACE_RECORDS;
+	uint32_t oldest = head - total;
+	TelemTraceChunk_t chunk;
+	uint8_t count = 0;
+
+	chunk.first = dump_next;
+	chunk.total = total;
+	chunk.fault = trace_buffer.fault;
+	chunk.tick_hz = CPU_BUS_CLK_HZ;
+	while (count < TELEM_TRACE_CHUNK && dump_next < total) {
+		chunk.record[count++] = trace_buffer.slot[(oldest + dump_next++) & (TRACE_RECORDS - 1)].record;
+	}
+	telemetry_send(TelemType_TraceChunk, &chunk, sizeof(chunk) - sizeof(chunk.record) + count * sizeof(TraceRecord_t));
+	if (dump_next >= total) {
+		dumping = FALSE;
+	}
+}
+
+// Fetches the stacked pc from whichever stack was in use and hands it to trace_hardfault.
+// Naked so no prologue moves the stack pointer before it is read.
+__attribute__((naked)) void trace_hardfault_isr(void) {
+	__asm volatile (
+		"movs r0, #4			\n"
+		"mov r1, lr				\n"
+		"tst r0, r1				\n"
+		"beq 1f					\n"
+		"mrs r0, psp			\n"
+		"b 2f					\n"
+		"1: mrs r0, msp			\n"
+		"2: ldr r0, [r0, #24]	\n"	// pc is 6 words into the exception frame
+		"ldr r1, =trace_hardfault	\n"
+		"bx r1					\n"
+		".ltorg					\n");
+}
+
+// Private function definitions
+// Freezes with the faulting pc and resets, the trace waits for the host in .noinit
+__attribute__((used)) static void trace_hardfault(uint32_t pc) {
+	trace_fault(TraceFault_HardFault, pc);
+	SCB_AIRCR = SCB_AIRCR_VECTKEY(0x5FA) | SCB_AIRCR_SYSRESETREQ_MASK;
+	for (;;) {
+	}
+}
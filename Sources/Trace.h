@@ -0,0 +1,69 @@
+/*
+ * Trace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_TRACE_H_
+#define SOURCES_TRACE_H_
+
+#include "PE_Types.h"
+#include "Cpu.h"
+#include "TelemetryFormat.h"
+#include "Timebase.h"
+
+// Circular trace of the last TRACE_RECORDS events, kept in RAM that startup doesn't clear
+// so it survives the reset after a hard fault. Stops recording (freezes) on a fault or a
+// TelemType_TraceDump and stays frozen until TelemType_TraceResume.
+// INT_Hard_Fault goes to trace_hardfault_isr, set in the Cpu component.
+
+// Config switches
+#define TRACE_PIXEL_EVENTS 0		// 1: one record per pixel from AO_OnEnd, fills the trace in 4 frames.
+
+// Public defines
+// 8 KB of the 16 KB m_data. The rest holds about 4 KB of variables, the 1 KB stack and
+// room to grow; the linker's heap/stack check fails the build if it ever doesn't fit.
+#define TRACE_RECORDS 1024			// Has to be a power of two.
+#define TRACE_ARM_US 2000000		// Line followed this long before losing it can freeze the trace.
+#define TRACE_LOST_US 250000		// No line this long counts as leaving the track.
+
+// Public typedefs
+// TraceRecord_t is packed for the wire, so field stores through it go out a byte at a time.
+// The slot lets trace() write a record as two word stores instead.
+typedef union TraceSlot_t {
+	TraceRecord_t record;
+	uint32_t word[2];				// ticks, then event | a8 << 8 | a16 << 16.
+} TraceSlot_t;
+
+typedef struct Trace_t {
+	TraceSlot_t slot[TRACE_RECORDS];	// First, so every slot is word-aligned.
+	uint32_t magic;
+	uint32_t head;					// Records ever written, the next one goes to head % TRACE_RECORDS.
+	volatile uint8_t fault;			// TraceFault_t, anything but None means frozen.
+} Trace_t;
+
+// Public variables
+extern Trace_t trace_buffer;
+
+// Public functions
+void trace_init(void);
+void trace_fault(TraceFault_t fault, uint32_t pc);
+void trace_resume(void);
+void trace_dump_start(void);
+void trace_dump_poll(void);
+void trace_hardfault_isr(void);
+
+// A handful of cycles, safe from any interrupt and the main loop
+static inline void trace(TraceEvent_t event, uint8_t a8, uint16_t a16) {
+	if (trace_buffer.fault != TraceFault_None) {
+		return;
+	}
+	EnterCritical();
+	TraceSlot_t *slot = &trace_buffer.slot[trace_buffer.head++ & (TRACE_RECORDS - 1)];
+	ExitCritical();
+	slot->word[0] = timebase_ticks();
+	slot->word[1] = event | ((uint32_t)a8 << 8) | ((uint32_t)a16 << 16);
+}
+
+#endif /* SOURCES_TRACE_H_ */
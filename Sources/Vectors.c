@@ -0,0 +1,32 @@
+/*
+ * Vectors.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "Cpu.h"
+#include "Vectors.h"
+
+// Private variables
+// VTOR needs the table aligned to its size rounded up to a power of two
+static volatile uint32_t table[VECTORS_COUNT] __attribute__((aligned(256)));
+
+// Public function definitions
+// Copies the flash table to RAM and switches to it, call before any vectors_set
+void vectors_init(void) {
+	const uint32_t *flash = (const uint32_t *)SCB_VTOR;
+	if (flash == (const uint32_t *)table) {
+		return;
+	}
+	EnterCritical();
+	for (int i = 0; i < VECTORS_COUNT; ++i) {
+		table[i] = flash[i];
+	}
+	SCB_VTOR = (uint32_t)table;
+	ExitCritical();
+}
+
+void vectors_set(IRQInterruptIndex vector, VectorHandler_t handler) {
+	table[vector] = (uint32_t)handler;
+}
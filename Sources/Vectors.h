@@ -0,0 +1,28 @@
+/*
+ * Vectors.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef SOURCES_VECTORS_H_
+#define SOURCES_VECTORS_H_
+
+#include "PE_Types.h"
+#include "IO_Map.h"
+
+// Processor Expert only puts a handler in the vector table for vectors one of its components
+// owns, the DMA channels used here have none. vectors_init moves the table to RAM so those
+// handlers can be installed at run time.
+
+// Public defines
+#define VECTORS_COUNT 48					// 16 core exceptions + 32 IRQs on the KL25.
+
+// Public typedefs
+typedef void (*VectorHandler_t)(void);
+
+// Public functions
+void vectors_init(void);
+void vectors_set(IRQInterruptIndex vector, VectorHandler_t handler);
+
+#endif /* SOURCES_VECTORS_H_ */
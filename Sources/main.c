@@ -63,6 +63,13 @@
 #include "IO_Map.h"
 /* User includes (#include below this line is not maintained by Processor Expert) */
 #include "Motors.h"
+#include "LineCamera.h"
+#include "Timebase.h"
+#include "Params.h"
+#include "SerialDMA.h"
+#include "Telemetry.h"
+#include "Trace.h"
+#include "Vectors.h"
 
 /*lint -save  -e970 Disable MISRA rule (6.3) checking. */
 int main(void)
@@ -76,7 +83,22 @@ int main(void)
 
   /* Write your code here */
   /* For example: for(;;) { } */
-  motors_set(MotorDir_Forward, 0xFFFF/2);
+  vectors_init(); // Before anything installs a handler
+  params_init();
+  timebase_init();
+  trace_init();
+  serial_init();
+  linecam_init();
+  linecam_start_frame();
+  linecam_cal_boot();
+  motors_init();
+  motors_set(MotorDir_Forward, 0); // The speed loop in LineCam_OnFrame takes over
+  for(;;) {
+    linecam_poll();
+    telemetry_poll();
+    trace_dump_poll();
+    motors_poll();
+  }
 
   /*** Don't write any code pass this line, or it will be deleted during code generation. ***/
   /*** RTOS startup code. Macro PEX_RTOS_START is defined by the RTOS component. DON'T MODIFY THIS CODE!!! ***/
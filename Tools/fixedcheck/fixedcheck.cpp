@@ -0,0 +1,144 @@
+/*
+ * fixedcheck.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Checks the firmware's fixed point routines (Sources/Fixed.h) against double references,
+ *  saturation and den == 0 included. Prints the worst error of each and exits 1 if any is
+ *  over its bound.
+ *
+ *  Build:  g++ -std=c++17 -O2 -I../host -I../../Sources -o fixedcheck fixedcheck.cpp -x c++ ../../Sources/Fixed.c
+ *
+ *  fixedcheck [samples]    Random samples per routine, 1000000 by default.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "Fixed.h"
+
+namespace {
+
+int failures = 0;
+
+void expect(bool ok, const char *what, long long a, long long b, long long got) {
+	if (!ok) {
+		if (failures < 20) {
+			std::printf("FAIL %s(%lld, %lld) = %lld\n", what, a, b, got);
+		}
+		++failures;
+	}
+}
+
+// Saturates a double reference the way the firmware does
+double saturate(double value) {
+	return std::fmax(std::fmin(value, Q16_MAX), Q16_MIN);
+}
+
+// Spread over every magnitude, not just the big ones a uniform draw would give
+int32_t draw(std::mt19937_64 &rng) {
+	int bits = rng() % 32;
+	int32_t value = static_cast<int32_t>(rng() & ((1ull << bits) - 1)) | (bits ? 1 << (bits - 1) : 0);
+	return (rng() & 1) ? -value : value;
+}
+
+void check_mul(std::mt19937_64 &rng, long samples) {
+	double worst = 0;
+	for (long n = 0; n < samples; ++n) {
+		Q16_t a = draw(rng);
+		Q16_t b = draw(rng);
+		Q16_t got = q16_mul(a, b);
+		double error = std::fabs(got - saturate(std::floor(static_cast<double>(a) * b / 65536)));
+		worst = std::fmax(worst, error);
+		expect(error <= 1, "q16_mul", a, b, got);
+	}
+	expect(q16_mul(Q16_MAX, Q16_FROM_INT(2)) == Q16_MAX, "q16_mul", Q16_MAX, Q16_FROM_INT(2), q16_mul(Q16_MAX, Q16_FROM_INT(2)));
+	expect(q16_mul(Q16_MIN, Q16_FROM_INT(2)) == Q16_MIN, "q16_mul", Q16_MIN, Q16_FROM_INT(2), q16_mul(Q16_MIN, Q16_FROM_INT(2)));
+	expect(q16_mul(Q16_MIN, -Q16_ONE) == Q16_MAX, "q16_mul", Q16_MIN, -Q16_ONE, q16_mul(Q16_MIN, -Q16_ONE));
+	std::printf("q16_mul   worst %.0f LSB\n", worst);
+}
+
+// Worst error in LSBs, and relative to the quotient where it is at least 1.0 so the LSB
+// doesn't hide the table's precision
+void check_div(std::mt19937_64 &rng, long samples) {
+	double worst = 0;
+	double worst_relative = 0;
+	for (long n = 0; n < samples; ++n) {
+		int32_t num = draw(rng);
+		int32_t den = draw(rng);
+		if (den == 0) {
+			continue;
+		}
+		Q16_t got = q16_div(num, den);
+		double exact = static_cast<double>(num) * 65536 / den;
+		double error = std::fabs(got - saturate(exact));
+		if (std::fabs(exact) >= 65536 && std::fabs(exact) <= Q16_MAX) {
+			worst_relative = std::fmax(worst_relative, error / std::fabs(exact));
+		}
+		worst = std::fmax(worst, std::fabs(exact) < 65536 ? error : 0);
+		expect(error <= 1 + std::fabs(exact) / (1 << 14), "q16_div", num, den, got);
+	}
+	expect(q16_div(1, 0) == Q16_MAX, "q16_div", 1, 0, q16_div(1, 0));
+	expect(q16_div(-1, 0) == Q16_MIN, "q16_div", -1, 0, q16_div(-1, 0));
+	expect(q16_div(0, 0) == Q16_MAX, "q16_div", 0, 0, q16_div(0, 0));
+	expect(q16_div(Q16_FROM_INT(30000), 1) == Q16_MAX, "q16_div", Q16_FROM_INT(30000), 1, q16_div(Q16_FROM_INT(30000), 1));
+	expect(q16_div(-Q16_FROM_INT(30000), 1) == Q16_MIN, "q16_div", -Q16_FROM_INT(30000), 1, q16_div(-Q16_FROM_INT(30000), 1));
+	expect(q16_div(Q16_MIN, -1) == Q16_MAX, "q16_div", Q16_MIN, -1, q16_div(Q16_MIN, -1));
+	std::printf("q16_div   worst %.0f LSB below 1.0, %.2g relative above (%.1f bits)\n",
+			worst, worst_relative, -std::log2(worst_relative));
+}
+
+void check_sqrt(std::mt19937_64 &rng, long samples) {
+	double worst = 0;
+	for (long n = 0; n < samples; ++n) {
+		Q16_t value = std::abs(draw(rng));
+		Q16_t got = q16_sqrt(value);
+		double error = std::fabs(got - std::floor(std::sqrt(value / 65536.0) * 65536));
+		worst = std::fmax(worst, error);
+		expect(error <= 1, "q16_sqrt", value, 0, got);
+	}
+	expect(q16_sqrt(-Q16_ONE) == 0, "q16_sqrt", -Q16_ONE, 0, q16_sqrt(-Q16_ONE));
+	expect(q16_sqrt(Q16_MAX) == 0xB504F3, "q16_sqrt", Q16_MAX, 0, q16_sqrt(Q16_MAX));
+	std::printf("q16_sqrt  worst %.0f LSB\n", worst);
+}
+
+void check_lerp(std::mt19937_64 &rng, long samples) {
+	double worst = 0;
+	for (long n = 0; n < samples; ++n) {
+		Q16_t prev = draw(rng);
+		Q16_t in = draw(rng);
+		Q15_t alpha = static_cast<Q15_t>(rng());
+		Q16_t got = q16_lerp(prev, in, alpha);
+		double exact = saturate(prev + alpha / 32768.0 * (static_cast<double>(in) - prev));
+		double error = std::fabs(got - exact);
+		worst = std::fmax(worst, error);
+		expect(error <= 1, "q16_lerp", prev, in, got);
+	}
+	expect(q16_lerp(Q16_MIN, Q16_MAX, Q15_ONE) == Q16_MAX - 0x20000, "q16_lerp", Q16_MIN, Q16_MAX, q16_lerp(Q16_MIN, Q16_MAX, Q15_ONE));
+	expect(q16_lerp(Q16_MAX, Q16_MIN, Q15_MIN) == Q16_MAX, "q16_lerp", Q16_MAX, Q16_MIN, q16_lerp(Q16_MAX, Q16_MIN, Q15_MIN));
+	std::printf("q16_lerp  worst %.0f LSB\n", worst);
+}
+
+void check_to_q8() {
+	expect(q16_to_q8(Q16(1.5)) == 384, "q16_to_q8", Q16(1.5), 0, q16_to_q8(Q16(1.5)));
+	expect(q16_to_q8(-Q16(1.5)) == -384, "q16_to_q8", -Q16(1.5), 0, q16_to_q8(-Q16(1.5)));
+	expect(q16_to_q8(Q16_FROM_INT(200)) == INT16_MAX, "q16_to_q8", Q16_FROM_INT(200), 0, q16_to_q8(Q16_FROM_INT(200)));
+	expect(q16_to_q8(-Q16_FROM_INT(200)) == INT16_MIN, "q16_to_q8", -Q16_FROM_INT(200), 0, q16_to_q8(-Q16_FROM_INT(200)));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	long samples = (argc > 1) ? std::atol(argv[1]) : 1000000;
+	std::mt19937_64 rng(454);
+	check_mul(rng, samples);
+	check_div(rng, samples);
+	check_sqrt(rng, samples);
+	check_lerp(rng, samples);
+	check_to_q8();
+	std::printf(failures ? "%d failures\n" : "ok\n", failures);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+/*
+ * PE_Types.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Stand-in for the Processor Expert header so firmware modules that only need the basic
+ *  types build on the host. Put this directory on the include path before ../../Sources, and
+ *  add -D__Events_H for modules whose headers pull in Events.h and with it every component.
+ */
+
+#ifndef TOOLS_HOST_PE_TYPES_H_
+#define TOOLS_HOST_PE_TYPES_H_
+
+#include <stdint.h>
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef uint32_t dword;
+
+#define PE_ISR(name) void name(void)
+
+#endif /* TOOLS_HOST_PE_TYPES_H_ */
@@ -0,0 +1,278 @@
+/*
+ * linebench.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Checks the bit-parallel edge extraction in Sources/LineFinder.c against the per-pixel scan it
+ *  replaced, then times both. Exits 1 on any mismatch.
+ *
+ *  Build:  g++ -std=c++17 -O2 -I../host -I../../Sources -D__Events_H -o linebench linebench.cpp -x c++ ../../Sources/LineFinder.c
+ *
+ *  linebench [frames]    Random frames for the equivalence check, 200000 by default.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "LineFinder.h"
+
+namespace {
+
+// The per-pixel versions from before linefind_edges, kept as the reference
+namespace per_pixel {
+
+uint8_t edges(const uint32_t *bits, uint8_t from, uint8_t to, uint8_t *edges, uint8_t max) {
+	uint8_t count = 0;
+	for (int i = from; i < to && count < max; ++i) {
+		uint32_t prev = (i == 0) ? 1u : LINECAM_BIT(bits, i - 1);
+		if (LINECAM_BIT(bits, i) != prev) {
+			edges[count++] = i;
+		}
+	}
+	return count;
+}
+
+bool run(const uint32_t *bits, uint8_t from, uint8_t to, uint8_t *start, uint8_t *end) {
+	int16_t run_start = -1;
+	for (int i = from; i < to - 1; ++i) {
+		uint8_t white = LINECAM_BIT(bits, i);
+		uint8_t white_next = LINECAM_BIT(bits, i + 1);
+		if (white && !white_next) {
+			run_start = i + 1;
+		}
+		else if (!white && white_next && run_start != -1) {
+			*start = run_start;
+			*end = i + 1;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+void add(LineScene_t *scene, uint8_t start, uint8_t end) {
+	if (end - start < LINEFIND_MIN_WIDTH || scene->count >= LINECLASS_MAX_SEGMENTS) {
+		return;
+	}
+	scene->segment[scene->count].start = start;
+	scene->segment[scene->count].width = end - start;
+	scene->count++;
+}
+
+LineClass_t classify(const uint32_t *bits, LineScene_t *scene) {
+	int16_t run_start = -1;
+	scene->count = 0;
+	for (int i = 0; i < LINECAM_PIXELS; ++i) {
+		uint8_t white = LINECAM_BIT(bits, i);
+		if (!white && run_start < 0) {
+			run_start = i;
+		}
+		else if (white && run_start >= 0) {
+			add(scene, run_start, i);
+			run_start = -1;
+		}
+	}
+	if (run_start >= 0) {
+		add(scene, run_start, LINECAM_PIXELS);
+	}
+
+	uint8_t tape = 0;
+	scene->type = LineClass_Ambiguous;
+	for (int i = 0; i < scene->count; ++i) {
+		if (scene->segment[i].width >= LINECLASS_CROSSING_WIDTH) {
+			scene->type = LineClass_Crossing;
+			return scene->type;
+		}
+		if (scene->segment[i].width <= LINEFIND_MAX_WIDTH) {
+			tape++;
+		}
+	}
+	if (scene->count == 0) {
+		scene->type = LineClass_Lost;
+	}
+	else if (scene->count == 1 && tape == 1) {
+		scene->type = LineClass_Line;
+	}
+	else if (scene->count == 3 && tape == 3) {
+		scene->type = LineClass_Finish;
+	}
+	return scene->type;
+}
+
+} // namespace per_pixel
+
+struct Frame {
+	uint32_t bits[LINECAM_WORDS];
+};
+
+int failures = 0;
+
+void fail(const char *what, const Frame &frame, int from, int to) {
+	if (failures < 20) {
+		std::printf("FAIL %s [%d, %d) %08x %08x %08x %08x\n", what, from, to,
+				frame.bits[0], frame.bits[1], frame.bits[2], frame.bits[3]);
+	}
+	++failures;
+}
+
+void set_dark(Frame &frame, int start, int end) {
+	for (int i = std::max(start, 0); i < std::min(end, LINECAM_PIXELS); ++i) {
+		frame.bits[i >> 5] &= ~(1u << (i & 31));
+	}
+}
+
+// White floor with a tape line, sometimes start/finish marks or a crossing, and a little noise
+Frame track_frame(std::mt19937 &rng) {
+	Frame frame;
+	std::memset(frame.bits, 0xFF, sizeof(frame.bits));
+	int center = rng() % LINECAM_PIXELS;
+	int width = 4 + rng() % 10;
+	set_dark(frame, center - width / 2, center + width / 2);
+	switch (rng() % 8) {
+	case 0:
+		set_dark(frame, center - 30, center - 30 + width);
+		set_dark(frame, center + 30, center + 30 + width);
+		break;
+	case 1:
+		set_dark(frame, center - 40, center + 40);
+		break;
+	default:
+		break;
+	}
+	for (int n = rng() % 3; n > 0; --n) {
+		int i = rng() % LINECAM_PIXELS;
+		frame.bits[i >> 5] ^= 1u << (i & 31);
+	}
+	return frame;
+}
+
+Frame random_frame(std::mt19937 &rng) {
+	Frame frame;
+	for (auto &word : frame.bits) {
+		word = rng();
+		// Mostly long runs, sometimes pure noise
+		if (rng() & 1) {
+			word = (rng() & 1) ? word | rng() | rng() : word & rng() & rng();
+		}
+	}
+	return frame;
+}
+
+// Every word boundary and both ends, where the carry and the masks can go wrong
+std::vector<Frame> edge_case_frames() {
+	std::vector<Frame> frames;
+	Frame frame;
+	for (uint32_t fill : {0u, 0xFFFFFFFFu, 0x55555555u, 0xAAAAAAAAu, 0x33333333u}) {
+		std::fill(std::begin(frame.bits), std::end(frame.bits), fill);
+		frames.push_back(frame);
+	}
+	for (int start : {0, 1, 30, 31, 32, 33, 63, 64, 95, 96, 126, 127}) {
+		for (int width : {1, 2, 3, 31, 32, 33, 64, 128}) {
+			std::fill(std::begin(frame.bits), std::end(frame.bits), 0xFFFFFFFFu);
+			set_dark(frame, start, start + width);
+			frames.push_back(frame);
+			for (auto &word : frame.bits) {
+				word = ~word;
+			}
+			frames.push_back(frame);
+		}
+	}
+	return frames;
+}
+
+void check(const Frame &frame, int from, int to) {
+	uint8_t expect_edges[LINEFIND_MAX_EDGES];
+	uint8_t got_edges[LINEFIND_MAX_EDGES];
+	uint8_t expect_count = per_pixel::edges(frame.bits, from, to, expect_edges, LINEFIND_MAX_EDGES);
+	uint8_t got_count = linefind_edges(frame.bits, from, to, got_edges, LINEFIND_MAX_EDGES);
+	if (got_count != expect_count || std::memcmp(got_edges, expect_edges, got_count) != 0) {
+		fail("linefind_edges", frame, from, to);
+	}
+
+	uint8_t expect_start = 0, expect_end = 0, got_start = 0, got_end = 0;
+	bool expect_found = per_pixel::run(frame.bits, from, to, &expect_start, &expect_end);
+	bool got_found = linefind_run(frame.bits, from, to, &got_start, &got_end);
+	if (got_found != expect_found || (got_found && (got_start != expect_start || got_end != expect_end))) {
+		fail("linefind_run", frame, from, to);
+	}
+}
+
+void check_classify(const Frame &frame) {
+	LineScene_t expect;
+	LineScene_t got;
+	per_pixel::classify(frame.bits, &expect);
+	lineclass_classify(frame.bits, &got);
+	bool same = got.type == expect.type && got.count == expect.count;
+	for (int i = 0; same && i < got.count; ++i) {
+		same = got.segment[i].start == expect.segment[i].start && got.segment[i].width == expect.segment[i].width;
+	}
+	if (!same) {
+		fail("lineclass_classify", frame, 0, LINECAM_PIXELS);
+	}
+}
+
+void check_frame(const Frame &frame, std::mt19937 &rng) {
+	check(frame, 0, LINECAM_PIXELS);
+	check_classify(frame);
+	int from = rng() % (LINECAM_PIXELS + 1);
+	int to = rng() % (LINECAM_PIXELS + 1);
+	check(frame, from, to);
+	check(frame, std::min(from, to), std::max(from, to));
+}
+
+// Nanoseconds per frame for one full-frame classify plus a tracking window around the line,
+// what LineCam_OnFrame does every frame
+template <typename Classify, typename Run>
+double time_frames(const std::vector<Frame> &frames, Classify classify, Run run) {
+	volatile unsigned sink = 0;
+	const int rounds = 50;
+	auto begin = std::chrono::steady_clock::now();
+	for (int r = 0; r < rounds; ++r) {
+		for (const Frame &frame : frames) {
+			LineScene_t scene;
+			uint8_t start = 0, end = 0;
+			sink += classify(frame.bits, &scene);
+			sink += run(frame.bits, 48, 80, &start, &end) + start;
+		}
+	}
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+	return elapsed.count() / (rounds * frames.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	long count = (argc > 1) ? std::atol(argv[1]) : 200000;
+	std::mt19937 rng(454);
+
+	for (const Frame &frame : edge_case_frames()) {
+		check_classify(frame);
+		for (int from = 0; from <= LINECAM_PIXELS; from += 1) {
+			for (int to : {from, from + 1, from + 2, from + 31, from + 32, from + 33, LINECAM_PIXELS}) {
+				check(frame, from, std::min(to, LINECAM_PIXELS));
+			}
+		}
+	}
+	for (long n = 0; n < count; ++n) {
+		check_frame(track_frame(rng), rng);
+		check_frame(random_frame(rng), rng);
+	}
+	std::printf("equivalence: %ld random frames plus edge cases, %d mismatches\n", 2 * count, failures);
+
+	std::vector<Frame> track(10000);
+	std::vector<Frame> noise(10000);
+	for (Frame &frame : track) frame = track_frame(rng);
+	for (Frame &frame : noise) frame = random_frame(rng);
+	struct { const char *name; const std::vector<Frame> &frames; } sets[] = {{"track", track}, {"random", noise}};
+	for (const auto &set : sets) {
+		double old_ns = time_frames(set.frames, per_pixel::classify, per_pixel::run);
+		double new_ns = time_frames(set.frames, lineclass_classify, linefind_run);
+		std::printf("%-7s per-pixel %7.1f ns/frame, bit-parallel %7.1f ns/frame, %.1fx\n",
+				set.name, old_ns, new_ns, old_ns / new_ns);
+	}
+	return failures ? 1 : 0;
+}
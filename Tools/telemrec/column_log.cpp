@@ -0,0 +1,293 @@
+/*
+ * column_log.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "column_log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TelemetryFormat.h"
+
+namespace column_log {
+
+static const char magic[8] = "TLMCOL1";
+static const char *suffix = ".col";
+
+// ColumnWriter
+ColumnWriter::ColumnWriter(const std::string &dir, const std::string &name, DType dtype, uint32_t elem_size) {
+	std::string path = dir + "/" + name + suffix;
+	file_ = std::fopen(path.c_str(), "wb");
+	if (!file_) {
+		throw std::runtime_error("can't create " + path);
+	}
+	std::setvbuf(file_, nullptr, _IOFBF, 1 << 16);
+	std::memset(&header_, 0, sizeof(header_));
+	std::memcpy(header_.magic, magic, sizeof(magic));
+	header_.dtype = static_cast<uint32_t>(dtype);
+	header_.elem_size = elem_size;
+	std::strncpy(header_.name, name.c_str(), sizeof(header_.name) - 1);
+	std::fwrite(&header_, sizeof(header_), 1, file_);
+}
+
+ColumnWriter::~ColumnWriter() {
+	flush();
+	std::fclose(file_);
+}
+
+void ColumnWriter::append(const void *element) {
+	std::fwrite(element, header_.elem_size, 1, file_);
+	header_.count++;
+}
+
+// Data first, then the count that makes it visible
+void ColumnWriter::flush() {
+	std::fflush(file_);
+	long end = std::ftell(file_);
+	std::fseek(file_, offsetof(ColumnHeader, count), SEEK_SET);
+	std::fwrite(&header_.count, sizeof(header_.count), 1, file_);
+	std::fflush(file_);
+	std::fseek(file_, end, SEEK_SET);
+}
+
+// LogWriter
+LogWriter::LogWriter(const std::string &dir) : dir_(dir) {
+	if (mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST) {
+		throw std::runtime_error("can't create " + dir);
+	}
+}
+
+LogWriter::~LogWriter() = default;
+
+ColumnWriter &LogWriter::column(const std::string &name, DType dtype, uint32_t elem_size) {
+	auto it = columns_.find(name);
+	if (it == columns_.end()) {
+		it = columns_.emplace(name, std::make_unique<ColumnWriter>(dir_, name, dtype, elem_size)).first;
+	}
+	return *it->second;
+}
+
+void LogWriter::flush() {
+	for (auto &column : columns_) {
+		column.second->flush();
+	}
+}
+
+// Names of the scalar channels, same order as TelemChannel_t
+static const char *sample_names[TelemChannel_Count - TELEM_FIRST_SAMPLE] = {
+	"line_center_q8", "error_q8", "servo_us", "velocity_q8", "velocity_desired_q8", "motor_duty",
+};
+static const bool sample_signed[TelemChannel_Count - TELEM_FIRST_SAMPLE] = {
+	false, true, false, true, true, false,
+};
+
+template <typename T>
+static bool read_payload(const uint8_t *payload, size_t length, T &out) {
+	if (length != sizeof(T)) {
+		return false;
+	}
+	std::memcpy(&out, payload, sizeof(T));
+	return true;
+}
+
+void LogWriter::on_packet(uint8_t type, const uint8_t *payload, size_t length) {
+	switch (type) {
+	case TelemType_Status: {
+		TelemStatus_t s;
+		if (!read_payload(payload, length, s)) break;
+		put("status.timestamp_us", DType::U32, s.timestamp_us);
+		put("status.frame", DType::U32, s.frame);
+		put("status.line_center_q8", DType::U16, s.line_center_q8);
+		put("status.error_q8", DType::I16, s.error_q8);
+		put("status.servo_us", DType::U16, s.servo_us);
+		put("status.velocity_q8", DType::I16, s.velocity_q8);
+		put("status.velocity_desired_q8", DType::I16, s.velocity_desired_q8);
+		put("status.motor_duty", DType::U16, s.motor_duty);
+		put("status.threshold", DType::U16, s.threshold);
+		put("status.exposure_us", DType::U16, s.exposure_us);
+		put("status.line_class", DType::U8, s.line_class);
+		put("status.line_confidence", DType::U8, s.line_confidence);
+		rows_++;
+		return;
+	}
+	case TelemType_FrameBinary: {
+		TelemFrameBinary_t f;
+		if (!read_payload(payload, length, f)) break;
+		put("binary.timestamp_us", DType::U32, f.timestamp_us);
+		column("binary.bits", DType::Bytes, sizeof(f.bits)).append(f.bits);
+		rows_++;
+		return;
+	}
+	case TelemType_FrameGray: {
+		TelemFrameGray_t f;
+		if (!read_payload(payload, length, f)) break;
+		put("gray.timestamp_us", DType::U32, f.timestamp_us);
+		column("gray.pixel", DType::Bytes, sizeof(f.pixel)).append(f.pixel);
+		rows_++;
+		return;
+	}
+	case TelemType_FrameKey:
+	case TelemType_FrameDelta: {
+		// Rebuilt delta frames land in their own group, same layout as binary
+		uint8_t bits[TELEM_BINARY_BYTES];
+		uint32_t timestamp_us;
+		bool decoded = (type == TelemType_FrameKey)
+			? frames_.key(payload, length, bits, timestamp_us)
+			: frames_.delta(payload, length, bits, timestamp_us);
+		if (decoded) {
+			put("frame.timestamp_us", DType::U32, timestamp_us);
+			column("frame.bits", DType::Bytes, sizeof(bits)).append(bits);
+		}
+		rows_++;
+		return;
+	}
+	case TelemType_TraceChunk: {
+		// One row per trace record, index counts from the oldest record of the dump
+		TelemTraceChunk_t t;
+		const size_t header = sizeof(t) - sizeof(t.record);
+		if (length < header || length > sizeof(t)) break;
+		std::memcpy(&t, payload, length);
+		if (length != header + t.count * sizeof(TraceRecord_t)) break;
+		for (uint8_t i = 0; i < t.count; ++i) {
+			put("trace.index", DType::U16, static_cast<uint16_t>(t.first + i));
+			put("trace.ticks", DType::U32, t.record[i].ticks);
+			put("trace.us", DType::F32, static_cast<float>(t.record[i].ticks * 1e6 / t.tick_hz));
+			put("trace.event", DType::U8, t.record[i].event);
+			put("trace.a8", DType::U8, t.record[i].a8);
+			put("trace.a16", DType::U16, t.record[i].a16);
+			put("trace.fault", DType::U8, t.fault);
+		}
+		rows_++;
+		return;
+	}
+	case TelemType_Samples: {
+		// Each scalar channel is its own group so they can run at different rates
+		TelemSamples_t s;
+		if (length < sizeof(s.timestamp_us) + sizeof(s.mask) || length > sizeof(s)) break;
+		std::memcpy(&s, payload, length);
+		size_t count = (length - sizeof(s.timestamp_us) - sizeof(s.mask)) / sizeof(uint16_t);
+		size_t n = 0;
+		for (int channel = TELEM_FIRST_SAMPLE; channel < TelemChannel_Count && n < count; ++channel) {
+			if (!(s.mask & TELEM_CHANNEL_BIT(channel))) continue;
+			std::string group = sample_names[channel - TELEM_FIRST_SAMPLE];
+			put(group + ".timestamp_us", DType::U32, s.timestamp_us);
+			if (sample_signed[channel - TELEM_FIRST_SAMPLE]) {
+				put(group + ".value", DType::I16, static_cast<int16_t>(s.value[n++]));
+			}
+			else {
+				put(group + ".value", DType::U16, s.value[n++]);
+			}
+		}
+		rows_++;
+		return;
+	}
+	case TelemType_Param: {
+		TelemParam_t p;
+		if (!read_payload(payload, length, p)) break;
+		put("param.id", DType::U8, p.id);
+		put("param.value", DType::F32, p.value);
+		rows_++;
+		return;
+	}
+	case TelemType_Ack:
+		rows_++;
+		return;
+	default:
+		break;
+	}
+	unknown_++;
+}
+
+// ColumnReader
+ColumnReader::ColumnReader(const std::string &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("can't open " + path);
+	}
+	struct stat st;
+	fstat(fd, &st);
+	size_ = st.st_size;
+	if (size_ < sizeof(ColumnHeader)) {
+		close(fd);
+		throw std::runtime_error(path + " is not a column file");
+	}
+	map_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map_ == MAP_FAILED) {
+		throw std::runtime_error("can't map " + path);
+	}
+	header_ = static_cast<const ColumnHeader *>(map_);
+	data_ = static_cast<const uint8_t *>(map_) + sizeof(ColumnHeader);
+	if (std::memcmp(header_->magic, magic, sizeof(magic)) != 0 || header_->elem_size == 0) {
+		munmap(map_, size_);
+		throw std::runtime_error(path + " is not a column file");
+	}
+	// A log still being written may hold more elements than its header admits, never fewer
+	count_ = std::min<uint64_t>(header_->count, (size_ - sizeof(ColumnHeader)) / header_->elem_size);
+}
+
+ColumnReader::~ColumnReader() {
+	munmap(map_, size_);
+}
+
+double ColumnReader::number(uint64_t i) const {
+	const uint8_t *p = element(i);
+	switch (dtype()) {
+	case DType::U8: return *p;
+	case DType::I8: return static_cast<int8_t>(*p);
+	case DType::U16: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+	case DType::I16: { int16_t v; std::memcpy(&v, p, 2); return v; }
+	case DType::U32: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+	case DType::I32: { int32_t v; std::memcpy(&v, p, 4); return v; }
+	case DType::F32: { float v; std::memcpy(&v, p, 4); return v; }
+	case DType::Bytes: break;
+	}
+	return 0;
+}
+
+std::string ColumnReader::text(uint64_t i) const {
+	if (dtype() != DType::Bytes) {
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.9g", number(i));
+		return buffer;
+	}
+	static const char hex[] = "0123456789abcdef";
+	std::string out;
+	const uint8_t *p = element(i);
+	for (uint32_t n = 0; n < header_->elem_size; ++n) {
+		out += hex[p[n] >> 4];
+		out += hex[p[n] & 0x0F];
+	}
+	return out;
+}
+
+std::vector<std::string> list_columns(const std::string &dir) {
+	std::vector<std::string> names;
+	DIR *d = opendir(dir.c_str());
+	if (!d) {
+		throw std::runtime_error("can't open " + dir);
+	}
+	while (struct dirent *entry = readdir(d)) {
+		std::string name = entry->d_name;
+		size_t length = std::strlen(suffix);
+		if (name.size() > length && name.compare(name.size() - length, length, suffix) == 0) {
+			names.push_back(name.substr(0, name.size() - length));
+		}
+	}
+	closedir(d);
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+} // namespace column_log
@@ -0,0 +1,105 @@
+/*
+ * column_log.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Columnar recording: a directory with one file per column. Every file is a 64 byte
+ *  ColumnHeader followed by count fixed size little-endian elements, so a column can be
+ *  mmap'ed and used as a plain array. Columns are grouped by the prefix before the '.',
+ *  all columns of a group have the same count and row i of each belongs together.
+ */
+
+#ifndef TOOLS_TELEMREC_COLUMN_LOG_HPP_
+#define TOOLS_TELEMREC_COLUMN_LOG_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame_delta.hpp"
+
+namespace column_log {
+
+enum class DType : uint32_t {
+	U8 = 1, I8, U16, I16, U32, I32, F32, Bytes,	// Bytes: opaque blob of elem_size bytes
+};
+
+struct ColumnHeader {
+	char magic[8];			// "TLMCOL1"
+	uint32_t dtype;			// DType.
+	uint32_t elem_size;		// Bytes per element.
+	uint64_t count;			// Elements written, updated on flush.
+	char name[40];			// group.field, NUL terminated.
+};
+static_assert(sizeof(ColumnHeader) == 64, "ColumnHeader is part of the file format");
+
+class ColumnWriter {
+public:
+	ColumnWriter(const std::string &dir, const std::string &name, DType dtype, uint32_t elem_size);
+	~ColumnWriter();
+	void append(const void *element);
+	void flush();				// Makes everything appended so far visible to readers.
+
+private:
+	std::FILE *file_;
+	ColumnHeader header_;
+};
+
+// Fans decoded packets out into columns, creating them on first use
+class LogWriter {
+public:
+	explicit LogWriter(const std::string &dir);
+	~LogWriter();
+	void on_packet(uint8_t type, const uint8_t *payload, size_t length);
+	void flush();
+	uint64_t rows() const { return rows_; }
+	uint64_t unknown() const { return unknown_; }
+	const frame_delta::Decoder &frames() const { return frames_; }
+
+private:
+	ColumnWriter &column(const std::string &name, DType dtype, uint32_t elem_size);
+	template <typename T> void put(const std::string &name, DType dtype, T value) {
+		column(name, dtype, sizeof(T)).append(&value);
+	}
+
+	std::string dir_;
+	std::map<std::string, std::unique_ptr<ColumnWriter>> columns_;
+	frame_delta::Decoder frames_;
+	uint64_t rows_ = 0;
+	uint64_t unknown_ = 0;
+};
+
+// A read-only mmap of one column file
+class ColumnReader {
+public:
+	explicit ColumnReader(const std::string &path);
+	~ColumnReader();
+	ColumnReader(const ColumnReader &) = delete;
+	ColumnReader &operator=(const ColumnReader &) = delete;
+
+	const ColumnHeader &header() const { return *header_; }
+	std::string name() const { return header_->name; }
+	DType dtype() const { return static_cast<DType>(header_->dtype); }
+	uint64_t count() const { return count_; }
+	const uint8_t *element(uint64_t i) const { return data_ + i * header_->elem_size; }
+	double number(uint64_t i) const;		// Numeric columns only.
+	std::string text(uint64_t i) const;		// Any column, blobs as hex.
+
+private:
+	void *map_ = nullptr;
+	size_t size_ = 0;
+	const ColumnHeader *header_ = nullptr;
+	const uint8_t *data_ = nullptr;
+	uint64_t count_ = 0;
+};
+
+// Every column file in dir, sorted by name
+std::vector<std::string> list_columns(const std::string &dir);
+
+} // namespace column_log
+
+#endif /* TOOLS_TELEMREC_COLUMN_LOG_HPP_ */
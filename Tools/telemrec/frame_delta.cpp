@@ -0,0 +1,107 @@
+/*
+ * frame_delta.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "frame_delta.hpp"
+
+#include <cstring>
+
+namespace frame_delta {
+
+static const int pixels = TELEM_BINARY_BYTES * 8;
+
+static bool bit(const uint8_t *bits, int i) {
+	return (bits[i >> 3] >> (i & 7)) & 1;
+}
+
+// Pixel -1 counts as white, an edge is every pixel that differs from the one before it
+std::vector<uint8_t> edges_of(const uint8_t *bits) {
+	std::vector<uint8_t> edges;
+	bool last = true;
+	for (int i = 0; i < pixels; ++i) {
+		if (bit(bits, i) != last) {
+			edges.push_back(i);
+			last = !last;
+		}
+	}
+	return edges;
+}
+
+void bits_of(const std::vector<uint8_t> &edges, uint8_t *bits) {
+	std::memset(bits, 0, TELEM_BINARY_BYTES);
+	bool white = true;
+	size_t e = 0;
+	for (int i = 0; i < pixels; ++i) {
+		while (e < edges.size() && edges[e] == i) {
+			white = !white;
+			e++;
+		}
+		if (white) {
+			bits[i >> 3] |= 1u << (i & 7);
+		}
+	}
+}
+
+// Decoder
+bool Decoder::key(const uint8_t *payload, size_t length, uint8_t *bits, uint32_t &timestamp_us) {
+	TelemFrameKey_t key;
+	if (length != sizeof(key)) {
+		return false;
+	}
+	std::memcpy(&key, payload, sizeof(key));
+	edges_ = edges_of(key.bits);
+	index_ = key.index;
+	timestamp_us_ = key.timestamp_us;
+	valid_ = true;
+	std::memcpy(bits, key.bits, TELEM_BINARY_BYTES);
+	timestamp_us = timestamp_us_;
+	frames_++;
+	return true;
+}
+
+bool Decoder::delta(const uint8_t *payload, size_t length, uint8_t *bits, uint32_t &timestamp_us) {
+	TelemFrameDelta_t delta;
+	const size_t header = sizeof(delta) - sizeof(delta.data);
+	if (length < header || length > sizeof(delta)) {
+		return false;
+	}
+	std::memcpy(&delta, payload, length);
+	if (!valid_ || delta.index != static_cast<uint16_t>(index_ + 1)) {
+		valid_ = false; // Lost a frame, wait for the next keyframe
+		skipped_++;
+		return false;
+	}
+
+	size_t count = delta.count & ~TELEM_DELTA_NIBBLES;
+	if (delta.count & TELEM_DELTA_NIBBLES) {
+		if (count != edges_.size() || length != header + (count + 1) / 2) {
+			valid_ = false;
+			skipped_++;
+			return false;
+		}
+		for (size_t i = 0; i < count; ++i) {
+			uint8_t nibble = (delta.data[i / 2] >> ((i & 1) * 4)) & 0x0F;
+			int move = (nibble & 0x08) ? nibble - 16 : nibble;
+			edges_[i] += move;
+		}
+	}
+	else {
+		if (length != header + count) {
+			valid_ = false;
+			skipped_++;
+			return false;
+		}
+		edges_.assign(delta.data, delta.data + count);
+	}
+	index_ = delta.index;
+	timestamp_us_ += delta.dt_us;
+	bits_of(edges_, bits);
+	timestamp_us = timestamp_us_;
+	frames_++;
+	return true;
+}
+
+} // namespace frame_delta
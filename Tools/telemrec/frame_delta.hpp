@@ -0,0 +1,45 @@
+/*
+ * frame_delta.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Edge-list delta frames, see TelemFrameKey_t and TelemFrameDelta_t.
+ */
+
+#ifndef TOOLS_TELEMREC_FRAME_DELTA_HPP_
+#define TOOLS_TELEMREC_FRAME_DELTA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TelemetryFormat.h"
+
+namespace frame_delta {
+
+std::vector<uint8_t> edges_of(const uint8_t *bits);
+void bits_of(const std::vector<uint8_t> &edges, uint8_t *bits);
+
+// Rebuilds binary frames from key and delta packets
+class Decoder {
+public:
+	// Both return true and fill bits and timestamp_us when the packet produced a frame
+	bool key(const uint8_t *payload, size_t length, uint8_t *bits, uint32_t &timestamp_us);
+	bool delta(const uint8_t *payload, size_t length, uint8_t *bits, uint32_t &timestamp_us);
+
+	uint64_t frames() const { return frames_; }
+	uint64_t skipped() const { return skipped_; }	// Deltas without the frame before them.
+
+private:
+	std::vector<uint8_t> edges_;
+	uint16_t index_ = 0;
+	uint32_t timestamp_us_ = 0;
+	bool valid_ = false;
+	uint64_t frames_ = 0;
+	uint64_t skipped_ = 0;
+};
+
+} // namespace frame_delta
+
+#endif /* TOOLS_TELEMREC_FRAME_DELTA_HPP_ */
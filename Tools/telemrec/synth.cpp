@@ -0,0 +1,102 @@
+/*
+ * synth.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "synth.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#include "FrameDelta.h"
+#include "LineFinder.h"
+#include "wire.hpp"
+
+namespace synth {
+
+void frame_packets(const Options &options, uint32_t frame, uint8_t &seq, std::vector<uint8_t> &out) {
+	const double t = frame / options.frame_rate;
+	const uint32_t timestamp_us = static_cast<uint32_t>(t * 1e6);
+	const double center = 64 + 30 * std::sin(2 * M_PI * 0.5 * t);	// Pixels.
+	const int start = static_cast<int>(center) - 4;
+	const int end = start + 8;
+	const double error = 64 - center;
+	const double velocity = 24 + 6 * std::cos(2 * M_PI * 0.2 * t);
+
+	TelemStatus_t status;
+	status.timestamp_us = timestamp_us;
+	status.frame = frame;
+	status.line_center_q8 = static_cast<uint16_t>(center * 256);
+	status.error_q8 = static_cast<int16_t>(error * 256);
+	status.servo_us = static_cast<uint16_t>(20000 - 750 + 30 * error);
+	status.velocity_q8 = static_cast<int16_t>(velocity * 256);
+	status.velocity_desired_q8 = static_cast<int16_t>((36 - std::fabs(error) / 2) * 256);
+	status.motor_duty = 0x7FFF;
+	status.threshold = 0x8000;
+	status.exposure_us = 5000;
+	status.line_class = 1;
+	status.line_confidence = 200;
+	wire::encode_packet(TelemType_Status, seq++, &status, sizeof(status), out);
+
+	TelemSamples_t samples;
+	samples.timestamp_us = timestamp_us;
+	samples.mask = 0;
+	uint16_t values[] = {
+		status.line_center_q8, static_cast<uint16_t>(status.error_q8), status.servo_us,
+		static_cast<uint16_t>(status.velocity_q8), static_cast<uint16_t>(status.velocity_desired_q8), status.motor_duty,
+	};
+	for (int channel = TELEM_FIRST_SAMPLE; channel < TelemChannel_Count; ++channel) {
+		samples.mask |= TELEM_CHANNEL_BIT(channel);
+		samples.value[channel - TELEM_FIRST_SAMPLE] = values[channel - TELEM_FIRST_SAMPLE];
+	}
+	wire::encode_packet(TelemType_Samples, seq++, &samples, sizeof(samples), out);
+
+	TelemFrameBinary_t binary;
+	binary.timestamp_us = timestamp_us;
+	std::memset(binary.bits, 0xFF, sizeof(binary.bits));
+	for (int i = start; i < end; ++i) {
+		if (i >= 0 && i < 128) {
+			binary.bits[i / 8] &= ~(1u << (i % 8));
+		}
+	}
+	wire::encode_packet(TelemType_FrameBinary, seq++, &binary, sizeof(binary), out);
+	if (options.delta) {
+		delta_packet(binary, seq, out);
+	}
+
+	if (options.gray_every && frame % options.gray_every == 0) {
+		TelemFrameGray_t gray;
+		gray.timestamp_us = timestamp_us;
+		for (int i = 0; i < TELEM_GRAY_PIXELS; ++i) {
+			gray.pixel[i] = (i >= start && i < end) ? 0x20 : 0xD0;
+		}
+		wire::encode_packet(TelemType_FrameGray, seq++, &gray, sizeof(gray), out);
+	}
+}
+
+// Encoded by the car's own FrameDelta.c
+void delta_packet(const TelemFrameBinary_t &binary, uint8_t &seq, std::vector<uint8_t> &out) {
+	static FrameDelta_t encoder = {};
+	uint32_t bits[LINECAM_WORDS];
+	std::memcpy(bits, binary.bits, sizeof(bits)); // Little-endian, same words as on the car
+	FrameDeltaPacket_t packet;
+	uint8_t length;
+	TelemType_t type = framedelta_encode(&encoder, binary.timestamp_us, bits, &packet, &length);
+	wire::encode_packet(type, seq++, &packet, length, out);
+}
+
+void corrupt(const Options &options, std::vector<uint8_t> &bytes, uint32_t &state) {
+	if (options.corrupt <= 0) {
+		return;
+	}
+	for (auto &byte : bytes) {
+		state = state * 1664525u + 1013904223u;
+		if ((state >> 8) * (1.0 / (1u << 24)) < options.corrupt) {
+			byte ^= 1u << (state & 7);
+		}
+	}
+}
+
+} // namespace synth
@@ -0,0 +1,53 @@
+/*
+ * synth.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#ifndef TOOLS_TELEMREC_SYNTH_HPP_
+#define TOOLS_TELEMREC_SYNTH_HPP_
+
+#include <cstdint>
+#include <vector>
+
+#include "TelemetryFormat.h"
+
+namespace synth {
+
+struct Options {
+	double seconds = 10;
+	double frame_rate = 200;		// Camera frames per second.
+	unsigned gray_every = 8;		// Frames between raw frames.
+	double corrupt = 0;				// Chance of flipping a byte, exercises resync.
+	bool delta = false;				// Also send the binary frame as key and delta frames.
+	uint32_t seed = 1;
+};
+
+// A car driving a wavy line: one status, one sample and one binary frame packet per
+// camera frame, a raw frame every gray_every. Calls write for every chunk of wire bytes.
+template <typename Write>
+void generate(const Options &options, Write &&write);
+
+// One frame's worth of wire bytes, exposed for generate
+void frame_packets(const Options &options, uint32_t frame, uint8_t &seq, std::vector<uint8_t> &out);
+void delta_packet(const TelemFrameBinary_t &binary, uint8_t &seq, std::vector<uint8_t> &out);
+void corrupt(const Options &options, std::vector<uint8_t> &bytes, uint32_t &state);
+
+template <typename Write>
+void generate(const Options &options, Write &&write) {
+	uint8_t seq = 0;
+	uint32_t state = options.seed;
+	std::vector<uint8_t> out;
+	uint32_t frames = static_cast<uint32_t>(options.seconds * options.frame_rate);
+	for (uint32_t frame = 0; frame < frames; ++frame) {
+		out.clear();
+		frame_packets(options, frame, seq, out);
+		corrupt(options, out, state);
+		write(out.data(), out.size());
+	}
+}
+
+} // namespace synth
+
+#endif /* TOOLS_TELEMREC_SYNTH_HPP_ */
@@ -0,0 +1,283 @@
+/*
+ * telemrec.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Records the car's telemetry stream into a columnar log (see column_log.hpp).
+ *
+ *  Build:  g++ -std=c++17 -O2 -I../host -I../../Sources -D__Events_H -o telemrec *.cpp \
+ *              -x c++ ../../Sources/FrameDelta.c ../../Sources/LineFinder.c
+ *
+ *  telemrec record <device|file|-> <dir> [--baud N]   Record until EOF or Ctrl-C.
+ *  telemrec info <dir>                                Columns and row counts.
+ *  telemrec csv <dir> <group> [--from us] [--to us]   One group as CSV on stdout.
+ *  telemrec synth <file|-> [--seconds S] [--rate HZ] [--corrupt P] [--delta 1]
+ *                                                     Fake stream, no car needed.
+ *
+ *  A pty stands in for the car with:
+ *    socat pty,raw,echo=0,link=/tmp/car - < <(telemrec synth - --seconds 60) &
+ *    telemrec record /tmp/car run1
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "column_log.hpp"
+#include "synth.hpp"
+#include "wire.hpp"
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int) {
+	stop = 1;
+}
+
+static int usage() {
+	std::fprintf(stderr,
+		"usage: telemrec record <device|file|-> <dir> [--baud N]\n"
+		"       telemrec info <dir>\n"
+		"       telemrec csv <dir> <group> [--from us] [--to us]\n"
+		"       telemrec synth <file|-> [--seconds S] [--rate HZ] [--corrupt P] [--delta 1]\n");
+	return 2;
+}
+
+// --name value pairs after the positional arguments
+static std::map<std::string, std::string> options(int argc, char **argv, int first) {
+	std::map<std::string, std::string> out;
+	for (int i = first; i + 1 < argc; i += 2) {
+		if (std::strncmp(argv[i], "--", 2) == 0) {
+			out[argv[i] + 2] = argv[i + 1];
+		}
+	}
+	return out;
+}
+
+static speed_t baud_constant(long baud) {
+	static const struct { long baud; speed_t constant; } table[] = {
+		{9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200},
+		{230400, B230400}, {460800, B460800}, {500000, B500000}, {921600, B921600},
+		{1000000, B1000000}, {2000000, B2000000},
+	};
+	for (auto &entry : table) {
+		if (entry.baud == baud) {
+			return entry.constant;
+		}
+	}
+	return 0;
+}
+
+// Raw 8N1 at baud for serial devices and ptys, anything else is read as is
+static int open_input(const std::string &path, long baud) {
+	if (path == "-") {
+		return STDIN_FILENO;
+	}
+	int fd = open(path.c_str(), O_RDONLY | O_NOCTTY);
+	if (fd < 0) {
+		std::perror(path.c_str());
+		return -1;
+	}
+	if (isatty(fd)) {
+		struct termios tio;
+		tcgetattr(fd, &tio);
+		cfmakeraw(&tio);
+		tio.c_cflag |= CLOCAL | CREAD;
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		speed_t speed = baud_constant(baud);
+		if (speed == 0) {
+			std::fprintf(stderr, "unsupported baud rate %ld\n", baud);
+			close(fd);
+			return -1;
+		}
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+static double now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void print_stats(const wire::Stats &stats, const column_log::LogWriter &log) {
+	std::fprintf(stderr, "%llu bytes, %llu packets, %llu lost, %llu crc errors, %llu framing errors, %llu unknown, "
+		"%llu delta frames, %llu skipped\n",
+		(unsigned long long)stats.bytes, (unsigned long long)stats.packets,
+		(unsigned long long)stats.lost_packets, (unsigned long long)stats.crc_errors,
+		(unsigned long long)stats.framing_errors, (unsigned long long)log.unknown(),
+		(unsigned long long)log.frames().frames(), (unsigned long long)log.frames().skipped());
+}
+
+static int record(const std::string &input, const std::string &dir, long baud) {
+	int fd = open_input(input, baud);
+	if (fd < 0) {
+		return 1;
+	}
+	column_log::LogWriter log(dir);
+	wire::Decoder decoder;
+	// No SA_RESTART, Ctrl-C has to break out of a blocking read
+	struct sigaction action;
+	std::memset(&action, 0, sizeof(action));
+	action.sa_handler = on_signal;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	// One big read per wakeup; decoding is a few ns per byte, far ahead of 1 Mbaud (100 kB/s)
+	std::vector<uint8_t> buffer(1 << 16);
+	double last_flush = now_s();
+	while (!stop) {
+		ssize_t n = read(fd, buffer.data(), buffer.size());
+		if (n == 0) {
+			break;
+		}
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			std::perror("read");
+			break;
+		}
+		decoder.feed(buffer.data(), n, [&](const wire::Packet &packet) {
+			log.on_packet(packet.type, packet.payload, packet.length);
+		});
+		if (now_s() - last_flush > 1.0) {
+			log.flush();
+			last_flush = now_s();
+			print_stats(decoder.stats(), log);
+		}
+	}
+	log.flush();
+	print_stats(decoder.stats(), log);
+	if (fd != STDIN_FILENO) {
+		close(fd);
+	}
+	return 0;
+}
+
+static int info(const std::string &dir) {
+	for (const auto &name : column_log::list_columns(dir)) {
+		column_log::ColumnReader column(dir + "/" + name + ".col");
+		std::printf("%-32s %10llu x %u bytes\n", column.name().c_str(),
+			(unsigned long long)column.count(), column.header().elem_size);
+	}
+	return 0;
+}
+
+// Rows of group whose timestamp_us is in [from, to]
+static int csv(const std::string &dir, const std::string &group, double from, double to) {
+	std::vector<std::unique_ptr<column_log::ColumnReader>> columns;
+	const column_log::ColumnReader *timestamp = nullptr;
+	for (const auto &name : column_log::list_columns(dir)) {
+		if (name.compare(0, group.size() + 1, group + ".") != 0) {
+			continue;
+		}
+		columns.push_back(std::make_unique<column_log::ColumnReader>(dir + "/" + name + ".col"));
+		if (name == group + ".timestamp_us") {
+			timestamp = columns.back().get();
+		}
+	}
+	// Time first, the rest in name order
+	std::stable_partition(columns.begin(), columns.end(), [&](const auto &column) { return column.get() == timestamp; });
+	if (columns.empty()) {
+		std::fprintf(stderr, "no group %s in %s\n", group.c_str(), dir.c_str());
+		return 1;
+	}
+
+	uint64_t rows = columns[0]->count();
+	for (const auto &column : columns) {
+		rows = std::min(rows, column->count());
+	}
+	// The car's timestamps only go up (until they wrap after 71 minutes), so bisect for the slice
+	uint64_t first = 0;
+	uint64_t last = rows;
+	if (timestamp) {
+		uint64_t lo = 0, hi = rows;
+		while (lo < hi) {
+			uint64_t mid = (lo + hi) / 2;
+			if (timestamp->number(mid) < from) lo = mid + 1; else hi = mid;
+		}
+		first = lo;
+		while (last > first && timestamp->number(last - 1) > to) {
+			last--;
+		}
+	}
+
+	for (size_t c = 0; c < columns.size(); ++c) {
+		std::printf("%s%s", c ? "," : "", columns[c]->name().c_str() + group.size() + 1);
+	}
+	std::printf("\n");
+	for (uint64_t row = first; row < last; ++row) {
+		for (size_t c = 0; c < columns.size(); ++c) {
+			std::printf("%s%s", c ? "," : "", columns[c]->text(row).c_str());
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
+
+static int synthesize(const std::string &output, const std::map<std::string, std::string> &opts) {
+	synth::Options options;
+	if (opts.count("seconds")) options.seconds = std::atof(opts.at("seconds").c_str());
+	if (opts.count("rate")) options.frame_rate = std::atof(opts.at("rate").c_str());
+	if (opts.count("corrupt")) options.corrupt = std::atof(opts.at("corrupt").c_str());
+	if (opts.count("delta")) options.delta = std::atoi(opts.at("delta").c_str()) != 0;
+	std::FILE *out = (output == "-") ? stdout : std::fopen(output.c_str(), "wb");
+	if (!out) {
+		std::perror(output.c_str());
+		return 1;
+	}
+	synth::generate(options, [&](const uint8_t *data, size_t length) {
+		std::fwrite(data, 1, length, out);
+	});
+	if (out != stdout) {
+		std::fclose(out);
+	}
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	if (argc < 3) {
+		return usage();
+	}
+	std::string command = argv[1];
+	try {
+		if (command == "record" && argc >= 4) {
+			auto opts = options(argc, argv, 4);
+			return record(argv[2], argv[3], opts.count("baud") ? std::atol(opts["baud"].c_str()) : 9600);
+		}
+		if (command == "info") {
+			return info(argv[2]);
+		}
+		if (command == "csv" && argc >= 4) {
+			auto opts = options(argc, argv, 4);
+			double from = opts.count("from") ? std::atof(opts["from"].c_str()) : 0;
+			double to = opts.count("to") ? std::atof(opts["to"].c_str()) : 1e300;
+			return csv(argv[2], argv[3], from, to);
+		}
+		if (command == "synth") {
+			return synthesize(argv[2], options(argc, argv, 3));
+		}
+	}
+	catch (const std::exception &e) {
+		std::fprintf(stderr, "telemrec: %s\n", e.what());
+		return 1;
+	}
+	return usage();
+}
@@ -0,0 +1,114 @@
+/*
+ * wire.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ */
+
+#include "wire.hpp"
+
+namespace wire {
+
+uint16_t crc16(uint16_t crc, const uint8_t *data, size_t length) {
+	for (size_t i = 0; i < length; ++i) {
+		crc ^= static_cast<uint16_t>(data[i]) << 8;
+		for (int bit = 0; bit < 8; ++bit) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+		}
+	}
+	return crc;
+}
+
+void cobs_encode(const uint8_t *data, size_t length, std::vector<uint8_t> &out) {
+	size_t code_at = out.size();
+	out.push_back(0);
+	uint8_t code = 1;
+	for (size_t i = 0; i < length; ++i) {
+		if (data[i] == 0) {
+			out[code_at] = code;
+			code_at = out.size();
+			out.push_back(0);
+			code = 1;
+			continue;
+		}
+		out.push_back(data[i]);
+		if (++code == 0xFF) {
+			out[code_at] = code;
+			code_at = out.size();
+			out.push_back(0);
+			code = 1;
+		}
+	}
+	out[code_at] = code;
+	out.push_back(0x00);
+}
+
+bool cobs_decode(const uint8_t *data, size_t length, std::vector<uint8_t> &out) {
+	out.clear();
+	size_t i = 0;
+	while (i < length) {
+		uint8_t code = data[i++];
+		if (code == 0 || i + code - 1 > length) {
+			return false;
+		}
+		out.insert(out.end(), data + i, data + i + code - 1);
+		i += code - 1;
+		if (code < 0xFF && i < length) {
+			out.push_back(0x00);
+		}
+	}
+	return true;
+}
+
+void encode_packet(uint8_t type, uint8_t seq, const void *payload, size_t length, std::vector<uint8_t> &out) {
+	std::vector<uint8_t> packet;
+	packet.reserve(length + 4);
+	packet.push_back(type);
+	packet.push_back(seq);
+	const uint8_t *bytes = static_cast<const uint8_t *>(payload);
+	packet.insert(packet.end(), bytes, bytes + length);
+	uint16_t crc = crc16(TELEM_CRC_INIT, packet.data(), packet.size());
+	packet.push_back(crc & 0xFF);
+	packet.push_back(crc >> 8);
+	cobs_encode(packet.data(), packet.size(), out);
+}
+
+bool Decoder::finish(Packet &packet) {
+	bool overflow = overflow_;
+	overflow_ = false;
+	if (encoded_.empty()) {
+		return false; // Back to back delimiters, nothing lost
+	}
+	bool decoded = !overflow && cobs_decode(encoded_.data(), encoded_.size(), decoded_);
+	encoded_.clear();
+	if (!decoded || decoded_.size() < 4 || decoded_.size() > TELEM_MAX_PACKET) {
+		stats_.framing_errors++;
+		bad_++;
+		return false;
+	}
+	size_t size = decoded_.size();
+	uint16_t crc = decoded_[size - 2] | (decoded_[size - 1] << 8);
+	if (crc16(TELEM_CRC_INIT, decoded_.data(), size - 2) != crc) {
+		stats_.crc_errors++;
+		bad_++;
+		return false;
+	}
+
+	packet.type = decoded_[0];
+	packet.seq = decoded_[1];
+	packet.payload = decoded_.data() + 2;
+	packet.length = size - 4;
+	if (have_seq_) {
+		// The bad packets are in the gap too, only count what never arrived at all. A corrupted
+		// delimiter can split or merge packets, so this is close but not exact.
+		uint8_t gap = packet.seq - next_seq_;
+		stats_.lost_packets += (gap > bad_) ? gap - bad_ : 0;
+	}
+	bad_ = 0;
+	have_seq_ = true;
+	next_seq_ = packet.seq + 1;
+	stats_.packets++;
+	return true;
+}
+
+} // namespace wire
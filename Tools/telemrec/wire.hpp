@@ -0,0 +1,85 @@
+/*
+ * wire.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: JPM
+ *
+ *  Host side of the telemetry framing in Sources/TelemetryFormat.h.
+ */
+
+#ifndef TOOLS_TELEMREC_WIRE_HPP_
+#define TOOLS_TELEMREC_WIRE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TelemetryFormat.h"
+
+namespace wire {
+
+uint16_t crc16(uint16_t crc, const uint8_t *data, size_t length);
+// Appends the encoded bytes and the 0x00 delimiter to out
+void cobs_encode(const uint8_t *data, size_t length, std::vector<uint8_t> &out);
+// Returns false for malformed input
+bool cobs_decode(const uint8_t *data, size_t length, std::vector<uint8_t> &out);
+// Builds a complete wire packet, [type][seq][payload][crc] COBS encoded plus delimiter
+void encode_packet(uint8_t type, uint8_t seq, const void *payload, size_t length, std::vector<uint8_t> &out);
+
+struct Packet {
+	uint8_t type;
+	uint8_t seq;
+	const uint8_t *payload;
+	size_t length;
+};
+
+struct Stats {
+	uint64_t bytes = 0;
+	uint64_t packets = 0;
+	uint64_t crc_errors = 0;
+	uint64_t framing_errors = 0;		// Bad COBS, too short or too long.
+	uint64_t lost_packets = 0;			// Gaps in seq not already counted as a crc or framing error.
+};
+
+// Splits a byte stream into packets. Feed it whatever read() returned, it calls sink
+// for every packet with a good CRC. Resyncs on the next delimiter after any error.
+class Decoder {
+public:
+	template <typename Sink>
+	void feed(const uint8_t *data, size_t length, Sink &&sink) {
+		stats_.bytes += length;
+		for (size_t i = 0; i < length; ++i) {
+			if (data[i] != 0x00) {
+				if (encoded_.size() < max_encoded) {
+					encoded_.push_back(data[i]);
+				}
+				else {
+					overflow_ = true;
+				}
+				continue;
+			}
+			Packet packet;
+			if (finish(packet)) {
+				sink(packet);
+			}
+		}
+	}
+
+	const Stats &stats() const { return stats_; }
+
+private:
+	static constexpr size_t max_encoded = TELEM_MAX_ENCODED + 64;
+	bool finish(Packet &packet);
+
+	std::vector<uint8_t> encoded_;
+	std::vector<uint8_t> decoded_;
+	bool overflow_ = false;
+	bool have_seq_ = false;
+	uint8_t next_seq_ = 0;
+	uint64_t bad_ = 0;					// Crc and framing errors since the last good packet.
+	Stats stats_;
+};
+
+} // namespace wire
+
+#endif /* TOOLS_TELEMREC_WIRE_HPP_ */